@@ -0,0 +1,439 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include <ECS.h>
+
+#include "Checkpoint.h"
+#include "Component.h"
+#include "Obstacles.h"
+#include "Render.h"
+#include "Simulation.h"
+#include "Spatial.h"
+#include "System.h"
+
+using namespace steering;
+
+namespace {
+
+/**
+ * Bytes stored per entity having the component types: the entity pack, and
+ * per pool the component plus its dense and sparse slots.
+ */
+template<class... ComponentTypes>
+double BytesPerEntity() {
+    return sizeof(ecs::Scene::EntityPack) +
+           ((sizeof(ComponentTypes) + sizeof(ecs::Entity::Index) + sizeof(uint32_t)) + ... + 0);
+}
+
+template<class... ComponentTypes>
+void SetCounters(benchmark::State &state, int64_t items) {
+    state.SetItemsProcessed(state.iterations() * items);
+    state.counters["bytes/entity"] = BytesPerEntity<ComponentTypes...>();
+}
+
+/**
+ * Add an agent at a random position with a random heading.
+ */
+ecs::Entity::Id NewAgent(ecs::Scene &scene, std::mt19937 &engine) {
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    auto angle = unit(engine) * 2.0f * glm::pi<float>();
+    auto head = glm::vec2(glm::cos(angle), glm::sin(angle));
+    auto id = scene.NewEntity();
+    scene.AddComponent<component::Transform>(
+        id,
+        glm::vec2(unit(engine) * SCREEN_W, unit(engine) * SCREEN_H),
+        head,
+        glm::vec2(1.0f, 1.0f)
+    );
+    scene.AddComponent<component::Move>(id, head * 80.0f, 1.0f, 120.0f, 60.0f);
+    scene.AddComponent<component::SteeringForce>(id);
+    return id;
+}
+
+/**
+ * Scene of n agents sharing the rows of the integration group, with the
+ * Transform and Move front buffers published.
+ */
+struct World {
+    explicit World(int64_t n) {
+        scene.Group<component::Transform,
+                    component::Move,
+                    component::SteeringForce>();
+        scene.DoubleBuffer<component::Transform>();
+        scene.DoubleBuffer<component::Move>();
+        std::mt19937 engine(0);
+        for (int64_t i = 0; i < n; i++) {
+            agents.push_back(NewAgent(scene, engine));
+        }
+    }
+
+    ecs::Scene scene;
+    std::vector<ecs::Entity::Id> agents;
+};
+
+const glm::vec2 TARGET(SCREEN_W / 2, SCREEN_H / 2);
+
+}  // namespace
+
+//=========================
+// ECS
+//=========================
+static void BM_EntityChurn(benchmark::State &state) {
+    ecs::Scene scene;
+    std::vector<ecs::Entity::Id> ids(state.range(0));
+    for (auto _ : state) {
+        for (auto &id : ids) {
+            id = scene.NewEntity();
+            scene.AddComponent<component::Transform>(id);
+            scene.AddComponent<component::Move>(id);
+        }
+        for (auto id : ids) {
+            scene.RemoveEntity(id);
+        }
+    }
+    SetCounters<component::Transform, component::Move>(state, state.range(0));
+}
+BENCHMARK(BM_EntityChurn)->Arg(1000)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+static void BM_EntityBatchChurn(benchmark::State &state) {
+    ecs::Scene scene;
+    std::vector<ecs::Entity::Id> ids;
+    for (auto _ : state) {
+        auto batch = scene.CreateBatch(state.range(0), component::Transform(), component::Move());
+        ids.assign(batch.begin(), batch.end());
+        scene.DestroyBatch(ids);
+    }
+    SetCounters<component::Transform, component::Move>(state, state.range(0));
+}
+BENCHMARK(BM_EntityBatchChurn)->Arg(1000)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+// Runs filling a fresh scene: from the heap, or from an arena cleared and
+// reset between runs
+static void BM_SceneRun(benchmark::State &state) {
+    std::unique_ptr<ecs::Arena> arena;
+    if (state.range(1) != 0) {
+        arena = std::make_unique<ecs::Arena>(1ull << 30, true);
+    }
+    ecs::Scene reused(arena.get());
+    for (auto _ : state) {
+        if (arena != nullptr) {
+            reused.CreateBatch(state.range(0), component::Transform(), component::Move(), component::SteeringForce());
+            reused.Clear();
+            arena->Reset();
+        } else {
+            ecs::Scene scene;
+            scene.CreateBatch(state.range(0), component::Transform(), component::Move(), component::SteeringForce());
+        }
+    }
+    SetCounters<component::Transform, component::Move, component::SteeringForce>(state, state.range(0));
+}
+BENCHMARK(BM_SceneRun)->ArgsProduct({ { 1000, 100000, 1000000 }, { 0, 1 } })->Unit(benchmark::kMillisecond);
+
+static void BM_CheckpointLoad(benchmark::State &state) {
+    typedef Checkpoint<component::Transform, component::Move, component::SteeringForce> AgentCheckpoint;
+    const char *path = "bench_steering.checkpoint";
+    World world(state.range(0));
+    if (!AgentCheckpoint::Save(world.scene, path)) {
+        state.SkipWithError("Can't write the checkpoint");
+        return;
+    }
+    World restored(0);
+    for (auto _ : state) {
+        AgentCheckpoint::Load(restored.scene, path);
+    }
+    std::remove(path);
+    SetCounters<component::Transform, component::Move, component::SteeringForce>(state, state.range(0));
+}
+BENCHMARK(BM_CheckpointLoad)->Arg(1000)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+static void BM_SceneViewEach(benchmark::State &state) {
+    World world(state.range(0));
+    for (auto _ : state) {
+        auto sum = glm::vec2(0.0f);
+        ecs::SceneView<component::Transform, component::Move>(world.scene).Each([&](
+                component::Transform &t,
+                component::Move      &m) {
+            sum += t.position + m.velocity;
+        });
+        benchmark::DoNotOptimize(sum);
+    }
+    SetCounters<component::Transform, component::Move, component::SteeringForce>(state, state.range(0));
+}
+BENCHMARK(BM_SceneViewEach)->Arg(1000)->Arg(100000)->Arg(1000000);
+
+static void BM_SceneViewIterator(benchmark::State &state) {
+    World world(state.range(0));
+    for (auto _ : state) {
+        auto sum = glm::vec2(0.0f);
+        for (auto id : ecs::SceneView<component::Transform, component::Move>(world.scene)) {
+            sum += world.scene.GetComponent<component::Transform>(id)->position;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    SetCounters<component::Transform, component::Move, component::SteeringForce>(state, state.range(0));
+}
+BENCHMARK(BM_SceneViewIterator)->Arg(1000)->Arg(100000)->Arg(1000000);
+
+//=========================
+// Behaviors
+//=========================
+static void BM_Seek(benchmark::State &state) {
+    World world(state.range(0));
+    for (auto id : world.agents) {
+        world.scene.AddComponent<component::Seek>(id);
+    }
+    for (auto _ : state) {
+        behavior::Seek(TARGET, world.scene);
+    }
+    SetCounters<component::Transform, component::Move, component::SteeringForce, component::Seek>(state, state.range(0));
+}
+BENCHMARK(BM_Seek)->Arg(1000)->Arg(100000);
+
+static void BM_Flee(benchmark::State &state) {
+    World world(state.range(0));
+    for (auto id : world.agents) {
+        world.scene.AddComponent<component::Flee>(id);
+    }
+    for (auto _ : state) {
+        behavior::Flee(TARGET, world.scene);
+    }
+    SetCounters<component::Transform, component::Move, component::SteeringForce, component::Flee>(state, state.range(0));
+}
+BENCHMARK(BM_Flee)->Arg(1000)->Arg(100000);
+
+static void BM_Arrive(benchmark::State &state) {
+    World world(state.range(0));
+    for (auto id : world.agents) {
+        world.scene.AddComponent<component::Arrive>(id);
+    }
+    for (auto _ : state) {
+        behavior::Arrive(TARGET, world.scene);
+    }
+    SetCounters<component::Transform, component::Move, component::SteeringForce, component::Arrive>(state, state.range(0));
+}
+BENCHMARK(BM_Arrive)->Arg(1000)->Arg(100000);
+
+static void BM_Pursuit(benchmark::State &state) {
+    World world(state.range(0));
+    for (size_t i = 0; i < world.agents.size(); i++) {
+        world.scene.AddComponent<component::Pursuit>(world.agents[i], world.agents[(i + 1) % world.agents.size()]);
+    }
+    world.scene.SwapBuffers();
+    for (auto _ : state) {
+        behavior::Pursuit(world.scene);
+    }
+    SetCounters<component::Transform, component::Move, component::SteeringForce, component::Pursuit>(state, state.range(0));
+}
+BENCHMARK(BM_Pursuit)->Arg(1000)->Arg(100000);
+
+static void BM_Evade(benchmark::State &state) {
+    World world(state.range(0));
+    for (size_t i = 0; i < world.agents.size(); i++) {
+        world.scene.AddComponent<component::Evade>(world.agents[i], world.agents[(i + 1) % world.agents.size()], 100.0f);
+    }
+    world.scene.SwapBuffers();
+    for (auto _ : state) {
+        behavior::Evade(world.scene);
+    }
+    SetCounters<component::Transform, component::Move, component::SteeringForce, component::Evade>(state, state.range(0));
+}
+BENCHMARK(BM_Evade)->Arg(1000)->Arg(100000);
+
+template<class Component, void (*Behavior)(const spatial::Grid &, ecs::Scene &, ThreadPool *)>
+static void BM_Flocking(benchmark::State &state) {
+    World world(state.range(0));
+    for (auto id : world.agents) {
+        world.scene.AddComponent<Component>(id);
+    }
+    spatial::Grid grid(glm::vec2(SCREEN_W, SCREEN_H), 50.0f);
+    grid.Build(world.scene);
+    for (auto _ : state) {
+        Behavior(grid, world.scene, nullptr);
+    }
+    SetCounters<component::Transform, component::Move, component::SteeringForce, Component>(state, state.range(0));
+}
+BENCHMARK_TEMPLATE(BM_Flocking, component::Separation, behavior::Separation)->Arg(1000)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_Flocking, component::Alignment, behavior::Alignment)->Arg(1000)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_Flocking, component::Cohesion, behavior::Cohesion)->Arg(1000)->Arg(10000);
+
+static void BM_GridBuild(benchmark::State &state) {
+    World world(state.range(0));
+    spatial::Grid grid(glm::vec2(SCREEN_W, SCREEN_H), 50.0f);
+    for (auto _ : state) {
+        grid.Build(world.scene);
+    }
+    SetCounters<component::Transform, component::Move, component::SteeringForce>(state, state.range(0));
+}
+BENCHMARK(BM_GridBuild)->Arg(1000)->Arg(100000);
+
+static void BM_Wander(benchmark::State &state) {
+    World world(state.range(0));
+    for (auto id : world.agents) {
+        auto target = world.scene.NewEntity();
+        auto forward = world.scene.NewEntity();
+        for (auto circle : { target, forward }) {
+            world.scene.AddComponent<component::Transform>(circle);
+            world.scene.AddComponent<component::Circle>(circle, 5.0f);
+        }
+        world.scene.AddComponent<component::Wander>(id, target, forward, 25.0f, 35.0f, 350.0f);
+    }
+    for (auto _ : state) {
+        behavior::Wander(world.scene, FIXED_DT);
+    }
+    SetCounters<component::Transform, component::Move, component::SteeringForce, component::Wander>(state, state.range(0));
+}
+BENCHMARK(BM_Wander)->Arg(1000)->Arg(100000);
+
+// Thousands of static obstacles and walls, found through their Bvh
+spatial::Obstacles Level(size_t n) {
+    std::mt19937 engine(1);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<spatial::Obstacle> obstacles;
+    std::vector<spatial::Wall> walls;
+    for (size_t i = 0; i < n; i++) {
+        auto p = glm::vec2(unit(engine) * SCREEN_W, unit(engine) * SCREEN_H);
+        obstacles.push_back(spatial::Obstacle{ p, 2.0f + unit(engine) * 8.0f });
+        auto q = glm::vec2(unit(engine) * SCREEN_W, unit(engine) * SCREEN_H);
+        walls.push_back(spatial::Wall(q, q + glm::vec2(unit(engine) - 0.5f, unit(engine) - 0.5f) * 40.0f));
+    }
+    return spatial::Obstacles(std::move(obstacles), std::move(walls));
+}
+
+static void BM_ObstacleAvoidance(benchmark::State &state) {
+    World world(state.range(0));
+    for (auto id : world.agents) {
+        world.scene.AddComponent<component::ObstacleAvoidance>(id, 6.0f, 30.0f);
+    }
+    auto obstacles = Level(4096);
+    for (auto _ : state) {
+        behavior::ObstacleAvoidance(obstacles, world.scene);
+    }
+    SetCounters<component::ObstacleAvoidance, component::Transform, component::Move, component::SteeringForce>(state, state.range(0));
+}
+BENCHMARK(BM_ObstacleAvoidance)->Arg(1000)->Arg(100000);
+
+static void BM_WallAvoidance(benchmark::State &state) {
+    World world(state.range(0));
+    for (auto id : world.agents) {
+        world.scene.AddComponent<component::WallAvoidance>(id, 30.0f);
+    }
+    auto obstacles = Level(4096);
+    for (auto _ : state) {
+        behavior::WallAvoidance(obstacles, world.scene);
+    }
+    SetCounters<component::WallAvoidance, component::Transform, component::Move, component::SteeringForce>(state, state.range(0));
+}
+BENCHMARK(BM_WallAvoidance)->Arg(1000)->Arg(100000);
+
+static void BM_ToWorld(benchmark::State &state) {
+    auto n = static_cast<size_t>(state.range(0));
+    std::default_random_engine engine(7);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<glm::vec2> points(n), positions(n), headings(n), world(n);
+    for (size_t i = 0; i < n; i++) {
+        points[i] = glm::vec2(dist(engine), dist(engine)) * 50.0f;
+        positions[i] = glm::vec2(dist(engine), dist(engine)) * 720.0f;
+        headings[i] = glm::normalize(glm::vec2(dist(engine), dist(engine)) + glm::vec2(0.0f, 2.0f));
+    }
+    for (auto _ : state) {
+        ToWorldN(n, points.data(), positions.data(), headings.data(), glm::vec2(1.0f), world.data());
+        benchmark::DoNotOptimize(world.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ToWorld)->Arg(1000)->Arg(100000);
+
+static void BM_Integrate(benchmark::State &state) {
+    World world(state.range(0));
+    for (auto _ : state) {
+        update::Integrate(world.scene, FIXED_DT);
+    }
+    SetCounters<component::Transform, component::Move, component::SteeringForce>(state, state.range(0));
+}
+BENCHMARK(BM_Integrate)->Arg(1000)->Arg(100000)->Arg(1000000);
+
+//=========================
+// Draw
+//=========================
+// The draw functions only fill a render::Batch, nothing is submitted to a renderer.
+const render::Camera SCREEN(glm::vec2(SCREEN_W, SCREEN_H) * 0.5f, glm::vec2(SCREEN_W, SCREEN_H));
+
+static void BM_DrawTriangle(benchmark::State &state) {
+    World world(state.range(0));
+    for (auto id : world.agents) {
+        world.scene.AddComponent<component::Triangle>(id, 6.0f);
+        world.scene.AddComponent<component::Color>(id, 96, 96, 96, 255);
+    }
+    render::Batch batch;
+    for (auto _ : state) {
+        batch.Clear();
+        draw::Triangle(batch, SCREEN, world.scene);
+        benchmark::DoNotOptimize(batch.Size());
+    }
+    SetCounters<component::Transform, component::Triangle, component::Color>(state, state.range(0));
+}
+BENCHMARK(BM_DrawTriangle)->Arg(1000)->Arg(100000);
+
+// Zoomed in on a 16th of the world, the grid only yields the visible agents
+static void BM_DrawTriangleCulled(benchmark::State &state) {
+    World world(state.range(0));
+    for (auto id : world.agents) {
+        world.scene.AddComponent<component::Triangle>(id, 6.0f);
+        world.scene.AddComponent<component::Color>(id, 96, 96, 96, 255);
+    }
+    spatial::Grid grid(glm::vec2(SCREEN_W, SCREEN_H), 50.0f);
+    grid.Build(world.scene);
+    auto camera = SCREEN;
+    camera.zoom = 4.0f;
+    render::Batch batch;
+    for (auto _ : state) {
+        batch.Clear();
+        draw::Triangle(batch, camera, grid, world.scene);
+        benchmark::DoNotOptimize(batch.Size());
+    }
+    SetCounters<component::Transform, component::Triangle, component::Color>(state, state.range(0));
+}
+BENCHMARK(BM_DrawTriangleCulled)->Arg(1000)->Arg(100000);
+
+static void BM_DrawCrosshair(benchmark::State &state) {
+    World world(state.range(0));
+    for (auto id : world.agents) {
+        world.scene.AddComponent<component::Crosshair>(id, 5.0f);
+        world.scene.AddComponent<component::Color>(id, 0, 0, 0, 255);
+    }
+    render::Batch batch;
+    for (auto _ : state) {
+        batch.Clear();
+        draw::Crosshair(batch, SCREEN, world.scene);
+        benchmark::DoNotOptimize(batch.Size());
+    }
+    SetCounters<component::Transform, component::Crosshair, component::Color>(state, state.range(0));
+}
+BENCHMARK(BM_DrawCrosshair)->Arg(1000)->Arg(100000);
+
+static void BM_DrawCircle(benchmark::State &state) {
+    World world(state.range(0));
+    for (auto id : world.agents) {
+        world.scene.AddComponent<component::Circle>(id, 25.0f);
+        world.scene.AddComponent<component::Color>(id, 0, 255, 0, 255);
+    }
+    render::Batch batch;
+    for (auto _ : state) {
+        batch.Clear();
+        draw::Circle(batch, SCREEN, world.scene);
+        benchmark::DoNotOptimize(batch.Size());
+    }
+    SetCounters<component::Transform, component::Circle, component::Color>(state, state.range(0));
+}
+BENCHMARK(BM_DrawCircle)->Arg(1000)->Arg(100000);
+
+BENCHMARK_MAIN();
@@ -20,73 +20,196 @@
  * ecs::Component:: A namespace that includes types and functions related to
  * components, including their creation and identification.
  *
+ * ecs::Span:: A view of contiguous elements, e.g. entity IDs.
+ *
+ * ecs::Allocator:: An interface for the memory of the component pools, and
+ * ecs::Arena:: an aligned bump allocator over one mapped region, reset in O(1).
+ *
  * ecs::ComponentPool:: A class that manages a pool of components of a particular type.
- * It allows adding and removing components for entities.
+ * It is a sparse set: live components are packed in a dense array that grows
+ * on demand, and a sparse array maps entity indices to dense rows.
  *
  * ecs::Scene:: The main class that represents a scene in the ECS. A scene consists
  * of a number of entities, each of which can have any number of components.
+ * Components of selected types can be double buffered for parallel reads.
+ *
+ * ecs::CommandBuffer:: A class that records structural changes to apply to a
+ * scene later, and ecs::CommandQueue:: one command buffer per thread.
+ *
+ * ecs::Prefab:: A class template that creates entities from a compile-time list
+ * of prototype components.
  *
  * ecs::SceneView:: A class that allows iterating over entities in a scene that
  * have specific component types.
  *
+ * ecs::ChunkView:: A class that allows iterating over a group of entities in
+ * fixed-size chunks of packed per-component columns.
+ *
+ * ecs::Snapshot:: A class that holds a read-only copy of the components of a
+ * particular type.
+ *
  * -----------------------------------------------------------------------------
  */
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <bitset>
 #include <cstdint>
+#include <cstring>
 #include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 //=========================
 // ECS
 //=========================
 namespace ecs {
 
-const uint64_t MAX_COMPONENTS(64);
+// The width of the component masks, i.e. the number of component types. It
+// can be defined by the build, e.g. -DECS_MAX_COMPONENTS=32.
+#ifndef ECS_MAX_COMPONENTS
+#define ECS_MAX_COMPONENTS 64
+#endif
+
+// Entity IDs are 32 bits instead of 64 if the build defines
+// ECS_COMPACT_ENTITY=1. See ecs::Entity.
+#ifndef ECS_COMPACT_ENTITY
+#define ECS_COMPACT_ENTITY 0
+#endif
+
+// The alignment of the first row of every component pool, a cache line by
+// default. It can be defined by the build, e.g. -DECS_POOL_ALIGNMENT=128.
+#ifndef ECS_POOL_ALIGNMENT
+#define ECS_POOL_ALIGNMENT 64
+#endif
+
+const uint64_t MAX_COMPONENTS(ECS_MAX_COMPONENTS);
+const uint64_t POOL_ALIGNMENT(ECS_POOL_ALIGNMENT);
+static_assert((POOL_ALIGNMENT & (POOL_ALIGNMENT - 1)) == 0);
 const uint64_t MAX_ENTITIES(1000000);
+const uint64_t CHUNK_SIZE(256);
+
+/**
+ * BitMask is a set of N bits stored in the smallest unsigned integer that
+ * holds them, e.g. 4 bytes for 32 bits. It has the part of the std::bitset
+ * interface the ECS uses.
+ */
+template<uint64_t N>
+class BitMask {
+public:
+    static_assert(0 < N && N <= 64);
+
+    typedef std::conditional_t<N <= 8,  uint8_t,
+            std::conditional_t<N <= 16, uint16_t,
+            std::conditional_t<N <= 32, uint32_t, uint64_t>>> Word;
+
+    constexpr BitMask() = default;
+    constexpr explicit BitMask(unsigned long long bits) : bits_(static_cast<Word>(bits)) {}
 
-// A mask used for representing and identifying components
-typedef std::bitset<MAX_COMPONENTS> ComponentMask;
+    constexpr bool test(uint64_t i) const { return (bits_ >> i) & 1u; }
+    constexpr bool any() const { return bits_ != 0; }
+    constexpr bool none() const { return bits_ == 0; }
+    constexpr uint64_t size() const { return N; }
+
+    uint64_t count() const {
+        uint64_t n = 0;
+        for (auto bits = bits_; bits != 0; bits &= bits - 1) {
+            n++;
+        }
+        return n;
+    }
+
+    BitMask &set(uint64_t i) { bits_ |= static_cast<Word>(Word(1) << i); return *this; }
+    BitMask &reset(uint64_t i) { bits_ &= static_cast<Word>(~(Word(1) << i)); return *this; }
+    BitMask &reset() { bits_ = 0; return *this; }
+
+    BitMask &operator&=(const BitMask &other) { bits_ &= other.bits_; return *this; }
+    BitMask &operator|=(const BitMask &other) { bits_ |= other.bits_; return *this; }
+
+    friend constexpr BitMask operator&(BitMask a, BitMask b) { return BitMask(a.bits_ & b.bits_); }
+    friend constexpr BitMask operator|(BitMask a, BitMask b) { return BitMask(a.bits_ | b.bits_); }
+    friend constexpr bool operator==(BitMask a, BitMask b) { return a.bits_ == b.bits_; }
+    friend constexpr bool operator!=(BitMask a, BitMask b) { return a.bits_ != b.bits_; }
+
+private:
+    Word bits_{ 0 };
+};
+
+// A mask used for representing and identifying components. Masks of up to 64
+// components are a single integer, wider ones a std::bitset.
+typedef std::conditional_t<(MAX_COMPONENTS <= 64),
+                           BitMask<MAX_COMPONENTS>,
+                           std::bitset<MAX_COMPONENTS>> ComponentMask;
 
 //=========================
 // Entity
 //=========================
 namespace Entity {
 
+/**
+ * An entity ID packs an index in the upper INDEX_BITS bits and a version in
+ * the lower VERSION_BITS bits. By default both have 32 bits. Compact IDs have
+ * 32 bits: a 20-bit index, i.e. up to 1048575 live entities, and a 12-bit
+ * version that wraps after 4096 reuses of an index.
+ */
+#if ECS_COMPACT_ENTITY
+typedef uint32_t Id;
+const uint32_t INDEX_BITS(20);
+#else
 typedef uint64_t Id;
+const uint32_t INDEX_BITS(32);
+#endif
 typedef uint32_t Index;
 typedef uint32_t Version;
 
+const uint32_t VERSION_BITS(sizeof(Id) * 8 - INDEX_BITS);
+// The largest index, which means removed
+const Index INVALID_INDEX(static_cast<Index>((uint64_t(1) << INDEX_BITS) - 1));
+const Version VERSION_MASK(static_cast<Version>((uint64_t(1) << VERSION_BITS) - 1));
+
 /**
- * Create a new entity ID from an index and version.
- * The index and version are packed into a 64b bit ID (32 bits each).
+ * Create a new entity ID from an index and version. The version is wrapped
+ * to VERSION_BITS.
  */
 static constexpr Id NewId(Index index, Version version) {
-    return static_cast<Id>(index) << 32 | static_cast<Id>(version);
+    return static_cast<Id>(static_cast<Id>(index & INVALID_INDEX) << VERSION_BITS |
+                           static_cast<Id>(version & VERSION_MASK));
 }
 
 /**
- * Extract the index from the entity ID. The index is stored in the upper 32 bits.
+ * Extract the index from the entity ID. The index is stored in the upper bits.
  */
 static constexpr Index GetIndex(Id id) {
-    return id >> 32;
+    return static_cast<Index>(id >> VERSION_BITS);
 }
 
 /**
- * Extract the version from the entity ID. The version is stored in the lower 32 bits.
+ * Extract the version from the entity ID. The version is stored in the lower bits.
  */
 static constexpr Version GetVersion(Id id) {
-    return static_cast<Version>(id);
+    return static_cast<Version>(id & VERSION_MASK);
 }
 
 /**
- * Validate the entity ID. An entity ID is invalid if the part is the maximum
- * value of uint32_t, which means removed.
+ * Validate the entity ID. An entity ID is invalid if the index is
+ * INVALID_INDEX, which means removed.
  */
 static constexpr bool IsValid(Id id) {
-    return (id >> 32) != static_cast<Index>(-1);
+    return GetIndex(id) != INVALID_INDEX;
 }
 }  // Entity
 
@@ -97,249 +220,1980 @@ namespace Component {
 
 typedef uint64_t Id;
 
+// IDs below this are reserved for the types registered with ECS_COMPONENT_ID;
+// the other types get the following IDs at runtime. The build can choose the
+// number, e.g. -DECS_STATIC_COMPONENTS=20 for a narrow mask; by default three
+// quarters of the mask are reserved, at most 32.
+#ifdef ECS_STATIC_COMPONENTS
+const Id STATIC_COMPONENTS(ECS_STATIC_COMPONENTS);
+#else
+const Id STATIC_COMPONENTS(std::min<Id>(32, MAX_COMPONENTS - MAX_COMPONENTS / 4));
+#endif
+static_assert(STATIC_COMPONENTS <= 64 && STATIC_COMPONENTS <= MAX_COMPONENTS);
+
+/**
+ * Traits holds the compile-time ID of a component type, if it has one.
+ */
+template<class T>
+struct Traits {
+    static constexpr bool STATIC = false;
+    static constexpr Id ID = 0;
+};
+
 /**
  * Create a new component ID. This function is thread-safe.
  */
-inline static Id NewId() {
-    static std::atomic<Id> counter(0);
+inline Id NewId() {
+    static std::atomic<Id> counter(STATIC_COMPONENTS);
     return counter++;
 }
 
 /**
- * Get the component ID for a specific component type. The component ID is a
- * static local variable that is initialized only once during the first call
- * for each component type.
+ * Get the component ID for a specific component type. Types registered with
+ * ECS_COMPONENT_ID have a constant ID. Other types get one the first time it
+ * is requested, from a static local variable shared by all translation
+ * units.
+ */
+template<class T>
+inline Id GetId() {
+    if constexpr (Traits<T>::STATIC) {
+        return Traits<T>::ID;
+    } else {
+        static Id id = NewId();
+        return id;
+    }
+}
+
+/**
+ * Info describes the layout of a component type, so that code handling
+ * components by ID, e.g. batches, snapshots or vectorized loops, can
+ * specialize on it.
+ */
+struct Info {
+    uint64_t      size{ 0 };
+    uint64_t alignment{ 1 };
+    bool       trivial{ true };  // trivially copyable
+};
+
+/**
+ * Get the info of a component type.
  */
 template<class T>
-inline static Id GetId() {
-    static Id id = NewId();
-    return id;
+constexpr Info InfoOf() {
+    return Info{ sizeof(T), alignof(T), std::is_trivially_copyable<T>::value };
+}
+
+/**
+ * Get the mask of component types. If all of them have a compile-time ID,
+ * the mask is a constant.
+ */
+template<class... ComponentTypes>
+inline ComponentMask MaskOf() {
+    if constexpr ((Traits<ComponentTypes>::STATIC && ...)) {
+        constexpr unsigned long long bits = ((1ull << Traits<ComponentTypes>::ID) | ... | 0ull);
+        return ComponentMask(bits);
+    } else {
+        ComponentMask mask;
+        (mask.set(GetId<ComponentTypes>()), ...);
+        return mask;
+    }
 }
 }  // Component
 
-//=========================
-// ComponentPool
-//=========================
-class ComponentPool {
+/**
+ * ComponentRegistry records the info of every component type by ID. Types
+ * are registered when their first pool is created, or explicitly with
+ * Register. Types without ECS_COMPONENT_ID get their ID on first use, so
+ * registering them in a fixed order at startup, before anything else uses
+ * them, gives them the same IDs in every process, e.g. for checkpoints.
+ * This class is thread-safe.
+ */
+class ComponentRegistry {
 public:
     /**
-     * Allocates enough memory to hold the maximum number of components of the
-     * specified size.
+     * Get the registry shared by all translation units.
      */
-    ComponentPool(uint64_t size) : size_(size) {
-        head_ = new char[size * MAX_ENTITIES];
+    static ComponentRegistry &Instance() {
+        static ComponentRegistry registry;
+        return registry;
     }
 
     /**
-     * Releases the memory allocated for components.
+     * Register a component type and get its ID. Throws std::out_of_range
+     * if the ID doesn't fit in a ComponentMask.
      */
-    ~ComponentPool() {
-        delete[] head_;
+    template<class T>
+    Component::Id Register() {
+        auto cid = Component::GetId<T>();
+        if (MAX_COMPONENTS <= cid) {
+            throw std::out_of_range("ecs::ComponentRegistry: component ID exceeds MAX_COMPONENTS");
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        infos_[cid] = Component::InfoOf<T>();
+        registered_.set(cid);
+        return cid;
     }
 
     /**
-     * Get a pointer to the component at the specified index in the pool.
+     * Check if a component ID belongs to a registered type.
      */
-    inline void *Get(Entity::Index index) const {
-        return (head_ + index * size_);
+    bool IsRegistered(Component::Id cid) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return cid < MAX_COMPONENTS && registered_.test(cid);
+    }
+
+    /**
+     * Get the info of a registered component type by ID. Throws
+     * std::out_of_range if no type is registered with it.
+     */
+    Component::Info GetInfo(Component::Id cid) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (MAX_COMPONENTS <= cid || !registered_.test(cid)) {
+            throw std::out_of_range("ecs::ComponentRegistry: component ID isn't registered");
+        }
+        return infos_[cid];
     }
 
 private:
+    ComponentRegistry() = default;
+
+    mutable std::mutex                             mutex_;
+    std::array<Component::Info, MAX_COMPONENTS>    infos_{};
+    ComponentMask                             registered_{};
+};
+
+//=========================
+// Span
+//=========================
+/**
+ * Span is a view of contiguous elements owned elsewhere.
+ */
+template<class T>
+class Span {
+public:
+    Span() = default;
+    Span(T *data, uint64_t size) : data_(data), size_(size) {}
+
+    template<class U, class = std::enable_if_t<std::is_convertible<U (*)[], T (*)[]>::value>>
+    Span(const Span<U> &other) : data_(other.data()), size_(other.size()) {}
+
+    template<class U, class = std::enable_if_t<std::is_convertible<U (*)[], T (*)[]>::value>>
+    Span(std::vector<U> &vector) : data_(vector.data()), size_(vector.size()) {}
+
+    template<class U, class = std::enable_if_t<std::is_convertible<const U (*)[], T (*)[]>::value>>
+    Span(const std::vector<U> &vector) : data_(vector.data()), size_(vector.size()) {}
+
+    T *data() const { return data_; }
+    uint64_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    T *begin() const { return data_; }
+    T *end() const { return data_ + size_; }
+    T &operator[](uint64_t i) const { return data_[i]; }
+
+private:
+    T       *data_{ nullptr };
     uint64_t size_{ 0 };
-    char    *head_{ nullptr };
 };
 
 //=========================
-// Scene
+// Allocator
 //=========================
-class Scene {
+/**
+ * Allocator provides the memory of component pools. Every pool of a scene
+ * allocates from the scene's allocator, on the thread making structural
+ * changes.
+ */
+class Allocator {
 public:
+    virtual ~Allocator() = default;
+
     /**
-     * EntityPack holds an entity ID and a component mask that represents which
-     * components the entity has.
+     * Allocate bytes at a multiple of alignment, a power of two. Throws
+     * std::bad_alloc if the memory is exhausted.
      */
-    struct EntityPack {
-        Entity::Id      id_{ static_cast<Entity::Id>(-1) };
-        ComponentMask mask_{ };
-    };
+    virtual void *Allocate(uint64_t bytes, uint64_t alignment) = 0;
 
     /**
-     * Create a new entity. The entity is either created by resuing an index
-     * from the freelist or by creating a new ID.
+     * Release memory returned by Allocate with the same bytes and alignment.
      */
-    Entity::Id NewEntity() {
-        if (!freelist_.empty()) {
-            auto  i = freelist_.back(); freelist_.pop_back();
-            auto id = Entity::NewId(i, Entity::GetVersion(entities_[i].id_));
-            entities_[i].id_ = id;
-            return id;
+    virtual void Deallocate(void *memory, uint64_t bytes, uint64_t alignment) = 0;
+};
+
+/**
+ * HeapAllocator allocates from the aligned global operator new. It is the
+ * allocator of scenes created without one. This class is thread-safe.
+ */
+class HeapAllocator final : public Allocator {
+public:
+    static HeapAllocator &Instance() {
+        static HeapAllocator allocator;
+        return allocator;
+    }
+
+    void *Allocate(uint64_t bytes, uint64_t alignment) override {
+        return ::operator new(bytes, std::align_val_t(alignment));
+    }
+
+    void Deallocate(void *memory, uint64_t, uint64_t alignment) override {
+        ::operator delete(memory, std::align_val_t(alignment));
+    }
+};
+
+/**
+ * Arena allocates by bumping an offset into one region reserved up front.
+ * Deallocate does nothing: the memory is only reused after Reset, which
+ * takes O(1) time whatever was allocated, e.g. between simulation runs.
+ * Pages are committed by the OS when first touched, so a large capacity
+ * only reserves address space.
+ *
+ * With huge pages, the region is mapped with MAP_HUGETLB if the system has
+ * huge pages reserved, and otherwise advised with MADV_HUGEPAGE so that
+ * transparent huge pages can back it. Either way fewer TLB entries cover
+ * the pools.
+ *
+ * The constructor throws std::bad_alloc if the region can't be mapped.
+ * This class isn't thread-safe, like the structural changes of a scene.
+ */
+class Arena final : public Allocator {
+public:
+    // Size of the huge pages the capacity is rounded to
+    static constexpr uint64_t HUGE_PAGE = 2ull << 20;
+
+    explicit Arena(uint64_t capacity, bool hugePages = false) {
+        capacity_ = (capacity + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+#if defined(__unix__) || defined(__APPLE__)
+        auto flags = MAP_PRIVATE | MAP_ANONYMOUS;
+        void *map = MAP_FAILED;
+#ifdef MAP_HUGETLB
+        // Reserved, so that mmap fails rather than the first touch when
+        // there are too few huge pages
+        if (hugePages) {
+            map = ::mmap(nullptr, capacity_, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0);
+            huge_ = map != MAP_FAILED;
         }
-        auto id = Entity::NewId(Entity::Index(entities_.size()), 0);
-        entities_.emplace_back(EntityPack{ id, ComponentMask() });
-        return id;
+#endif
+#ifdef MAP_NORESERVE
+        flags |= MAP_NORESERVE;
+#endif
+        if (map == MAP_FAILED) {
+            map = ::mmap(nullptr, capacity_, PROT_READ | PROT_WRITE, flags, -1, 0);
+        }
+        if (map == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+#ifdef MADV_HUGEPAGE
+        if (hugePages && !huge_) {
+            ::madvise(map, capacity_, MADV_HUGEPAGE);
+        }
+#endif
+        memory_ = static_cast<char *>(map);
+#else
+        memory_ = static_cast<char *>(::operator new(capacity_, std::align_val_t(HUGE_PAGE)));
+#endif
     }
 
-    /**
-     * Remove an entity. The entity's ID is invalidated and added to the
-     * freelist, and all its components are removed.
-     */
-    void RemoveEntity(Entity::Id id) {
-        auto i = Entity::GetIndex(id);
-        entities_[i].id_ = Entity::NewId(
-            Entity::Index(-1),
-            Entity::GetVersion(id) + 1
-        );
-        entities_[i].mask_.reset();
-        freelist_.push_back(i);
+    ~Arena() override {
+#if defined(__unix__) || defined(__APPLE__)
+        ::munmap(memory_, capacity_);
+#else
+        ::operator delete(memory_, std::align_val_t(HUGE_PAGE));
+#endif
+    }
+
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    void *Allocate(uint64_t bytes, uint64_t alignment) override {
+        auto offset = (used_ + alignment - 1) & ~(alignment - 1);
+        if (capacity_ < offset || capacity_ - offset < bytes) {
+            throw std::bad_alloc();
+        }
+        used_ = offset + bytes;
+        return memory_ + offset;
     }
 
+    void Deallocate(void *, uint64_t, uint64_t) override {}
+
     /**
-     * Check if an entity has a component of a specific type.
+     * Make all the memory available again. Nothing allocated from the arena
+     * may be used afterwards, e.g. call Scene::Clear first.
      */
-    template<class T>
-    bool HasComponent(Entity::Id id) {
-        auto   i = Entity::GetIndex(id);
-        auto cid = Component::GetId<T>();
-        return entities_[i].mask_.test(cid);
+    void Reset() {
+        used_ = 0;
     }
 
     /**
-     * Add a component to an entity. The component is created in the pool
-     * corresponding to the component type.
+     * Commit the pages of a byte range of the region by writing them, e.g.
+     * from the worker threads that will use them, so that the first-touch
+     * policy of a NUMA system places every page on its toucher's node. The
+     * contents are kept.
      */
-    template<class T, typename... Args>
-    T *AddComponent(Entity::Id id, Args&&... args) {
-        auto   i = Entity::GetIndex(id);
-        auto cid = Component::GetId<T>();
-        if (pools_.size() <= cid) {
-            pools_.resize(cid + MAX_COMPONENTS / 4);
+    void Touch(uint64_t begin, uint64_t end) {
+        const uint64_t page = PageSize();
+        end = std::min(end, capacity_);
+        for (auto offset = begin / page * page; offset < end; offset += page) {
+            auto byte = static_cast<volatile char *>(memory_ + offset);
+            *byte = *byte;
         }
-        if (pools_[cid] == nullptr) {
-            pools_[cid] = std::make_unique<ComponentPool>(sizeof(T));
-        }
-        auto component = new (pools_[cid]->Get(i)) T(std::forward<Args>(args)...);
-        entities_[i].mask_.set(cid);
-        return component;
     }
 
     /**
-     * Remove a component from an entity.
+     * Get the size of the pages backing the region.
      */
-    template<class T>
-    void RemoveComponent(Entity::Id id) {
-        auto   i = Entity::GetIndex(id);
-        auto cid = Component::GetId<T>();
-        if (!HasComponent<T>(id)) {
-            throw;
-        }
-        if (entities_[i].id_ != id) {
-            throw;
-        }
-        entities_[i].mask_.reset(cid);
+    uint64_t PageSize() const {
+#if defined(__unix__) || defined(__APPLE__)
+        return huge_ ? HUGE_PAGE : static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+#else
+        return 4096;
+#endif
+    }
+
+    uint64_t GetCapacity() const {
+        return capacity_;
     }
 
     /**
-     * Get a component from an entity.
+     * Get the bytes allocated since the last Reset, with alignment padding.
      */
-    template<class T>
-    T *GetComponent(Entity::Id id) {
-        auto   i = Entity::GetIndex(id);
-        auto cid = Component::GetId<T>();
-        if (!HasComponent<T>(id)) {
-            throw;
-        }
-        if (entities_[i].id_ != id) {
-            throw;
-        }
-        return static_cast<T *>(pools_[cid]->Get(i));
+    uint64_t GetUsed() const {
+        return used_;
     }
 
     /**
-     * Get a const reference to the vector of entities.
+     * Check if the region is mapped with MAP_HUGETLB.
      */
-    const std::vector<EntityPack> &GetEntities() const {
-        return entities_;
+    bool IsHuge() const {
+        return huge_;
     }
 
 private:
-    std::vector<EntityPack>    entities_{};
-    std::vector<Entity::Index> freelist_{};
-    std::vector<std::unique_ptr<ComponentPool>> pools_{};
+    char      *memory_{ nullptr };
+    uint64_t capacity_{ 0 };
+    uint64_t     used_{ 0 };
+    bool         huge_{ false };
 };
 
 /**
- * SceneView allows to iterate over entities in a scene that have specific
- * component types.
+ * Buffer is a growable array of bytes whose first byte is aligned, in
+ * memory from an Allocator. It has the part of the std::vector interface
+ * the component pools use. A copy is allocated from the heap, e.g. for a
+ * Snapshot that outlives an arena's Reset; an assigned buffer keeps its
+ * own allocator.
  */
-template<class... ComponentTypes>
-class SceneView {
+class Buffer {
 public:
-    /**
-     * Constructor.
-     */
-    SceneView(Scene &scene) : scene_(&scene) {
-        if (sizeof...(ComponentTypes) == 0) {
-            all_ = true;
-        } else {
-            Component::Id ids[] = { Component::GetId<ComponentTypes>() ... };
-            for (auto i = 0; i < sizeof...(ComponentTypes); i++) {
-                mask_.set(ids[i]);
+    Buffer() = default;
+
+    Buffer(Allocator *allocator, uint64_t alignment)
+        : allocator_(allocator != nullptr ? allocator : &HeapAllocator::Instance()),
+          alignment_(std::max(alignment, POOL_ALIGNMENT)) {}
+
+    Buffer(const Buffer &other) : alignment_(other.alignment_) {
+        assign(other.data_, other.data_ + other.size_);
+    }
+
+    Buffer(Buffer &&other) noexcept {
+        Swap(other);
+    }
+
+    ~Buffer() {
+        release();
+    }
+
+    Buffer &operator=(const Buffer &other) {
+        if (this != &other) {
+            if (alignment_ < other.alignment_) {
+                release();
+                alignment_ = other.alignment_;
             }
+            assign(other.data_, other.data_ + other.size_);
         }
+        return *this;
     }
 
-    /**
-     * Iterator allows to iterate over entities in a SceneView.
-     */
-    struct Iterator {
-        Iterator(Scene *scene, Entity::Index index, ComponentMask mask, bool all)
-            : scene_(scene), index_(index), mask_(mask), all_(all) {}
+    Buffer &operator=(Buffer &&other) noexcept {
+        Swap(other);
+        return *this;
+    }
 
-        Entity::Id operator*() const {
-            return scene_->GetEntities()[index_].id_;
-        }
+    char *data() { return data_; }
+    const char *data() const { return data_; }
+    uint64_t size() const { return size_; }
+    uint64_t capacity() const { return capacity_; }
 
-        bool operator==(const Iterator &other) const {
-            return index_ == other.index_;
+    void reserve(uint64_t bytes) {
+        if (capacity_ < bytes) {
+            Reallocate(bytes);
         }
+    }
 
-        bool operator!=(const Iterator &other) const {
-            return index_ != other.index_;
+    /**
+     * Resize the buffer, growing its capacity geometrically. New bytes are
+     * zeroed.
+     */
+    void resize(uint64_t bytes) {
+        if (capacity_ < bytes) {
+            Reallocate(std::max(bytes, capacity_ * 2));
         }
-
-        bool IsValid() {
-            return Entity::IsValid(scene_->GetEntities()[index_].id_) &&
-                  (all_ || mask_ == (mask_ & scene_->GetEntities()[index_].mask_));
+        if (size_ < bytes) {
+            std::memset(data_ + size_, 0, bytes - size_);
         }
+        size_ = bytes;
+    }
 
-        Iterator &operator++() {
-            while (++index_ < scene_->GetEntities().size() && !IsValid());
-            return *this;
+    void assign(const char *first, const char *last) {
+        auto bytes = static_cast<uint64_t>(last - first);
+        size_ = 0;
+        reserve(bytes);
+        if (bytes != 0) {
+            std::memcpy(data_, first, bytes);
         }
+        size_ = bytes;
+    }
 
-        Scene        *scene_{ nullptr };
-        Entity::Index index_{ static_cast<Entity::Index>(-1) };
-        ComponentMask  mask_{ };
-        bool            all_{ false };
-    };
+    void clear() {
+        size_ = 0;
+    }
 
-    const Iterator begin() const {
-        int first = 0;
-        while (first < scene_->GetEntities().size() &&
-              (mask_ != (mask_ & scene_->GetEntities()[first].mask_) || !Entity::IsValid(scene_->GetEntities()[first].id_))) {
-            first++;
+    /**
+     * Return the memory to the allocator.
+     */
+    void release() {
+        if (data_ != nullptr) {
+            allocator_->Deallocate(data_, capacity_, alignment_);
         }
-        return Iterator(scene_, first, mask_, all_);
+        data_ = nullptr;
+        size_ = 0;
+        capacity_ = 0;
     }
 
-    const Iterator end() const {
-        return Iterator(scene_, Entity::Index(scene_->GetEntities().size()), mask_, all_);
+private:
+    void Reallocate(uint64_t capacity) {
+        auto memory = static_cast<char *>(allocator_->Allocate(capacity, alignment_));
+        if (size_ != 0) {
+            std::memcpy(memory, data_, size_);
+        }
+        if (data_ != nullptr) {
+            allocator_->Deallocate(data_, capacity_, alignment_);
+        }
+        data_ = memory;
+        capacity_ = capacity;
     }
 
-private:
-    Scene       *scene_{ nullptr };
-    bool           all_{ false };
-    ComponentMask mask_{ };
+    void Swap(Buffer &other) {
+        std::swap(allocator_, other.allocator_);
+        std::swap(alignment_, other.alignment_);
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+    }
+
+    Allocator *allocator_{ &HeapAllocator::Instance() };
+    uint64_t   alignment_{ POOL_ALIGNMENT };
+    char           *data_{ nullptr };
+    uint64_t        size_{ 0 };
+    uint64_t    capacity_{ 0 };
 };
 
-}  // ecs
+//=========================
+// ComponentPool
+//=========================
+class ComponentPool {
+public:
+    /**
+     * Sparse slot value for an entity index without a component in the pool.
+     */
+    static constexpr uint32_t NONE = static_cast<uint32_t>(-1);
+
+    /**
+     * Create an empty pool for components of the specified size. Memory is
+     * allocated on demand as components are added.
+     */
+    ComponentPool(uint64_t size) : size_(size) {
+        info_.size = size;
+    }
+
+    /**
+     * Create an empty pool for components of a type with the specified info,
+     * whose rows are allocated from an allocator, or the heap if nullptr.
+     * The first row is aligned to POOL_ALIGNMENT, or to the type's alignment
+     * if it is larger.
+     */
+    ComponentPool(const Component::Info &info, Allocator *allocator = nullptr)
+        : size_(info.size),
+          info_(info),
+          data_(allocator, info.alignment),
+          front_(allocator, info.alignment) {}
+
+    /**
+     * Get the info of the component type, as registered. Pools created from a
+     * size only are assumed to hold trivially copyable, unaligned bytes.
+     */
+    inline const Component::Info &GetInfo() const {
+        return info_;
+    }
+
+    /**
+     * Check if the entity at the specified index has a component in the pool.
+     */
+    inline bool Has(Entity::Index index) const {
+        return index < sparse_.size() && sparse_[index] != NONE;
+    }
+
+    /**
+     * Get the memory for the component of the entity at the specified index,
+     * appending a new row to the dense array if the entity has none yet.
+     * Pointers into the pool are invalidated when the dense array grows.
+     */
+    inline void *Add(Entity::Index index) {
+        if (sparse_.size() <= index) {
+            sparse_.resize(index + 1, NONE);
+        }
+        if (sparse_[index] != NONE) {
+            return Get(index);
+        }
+        sparse_[index] = static_cast<uint32_t>(dense_.size());
+        dense_.push_back(index);
+        data_.resize(data_.size() + size_);
+        if (buffered_) {
+            front_.resize(data_.size());
+        }
+        if (tracked_) {
+            ticks_.push_back(tick_);
+        }
+        return data_.data() + (dense_.size() - 1) * size_;
+    }
+
+    /**
+     * Remove the component of the entity at the specified index. The last row
+     * is moved into the freed one so that live components stay contiguous.
+     */
+    inline void Remove(Entity::Index index) {
+        auto row  = sparse_[index];
+        auto last = static_cast<uint32_t>(dense_.size() - 1);
+        if (row != last) {
+            std::memcpy(data_.data() + row * size_, data_.data() + last * size_, size_);
+            if (buffered_) {
+                std::memcpy(front_.data() + row * size_, front_.data() + last * size_, size_);
+            }
+            if (tracked_) {
+                ticks_[row] = ticks_[last];
+            }
+            dense_[row] = dense_[last];
+            sparse_[dense_[row]] = row;
+        }
+        dense_.pop_back();
+        data_.resize(last * size_);
+        if (buffered_) {
+            front_.resize(last * size_);
+        }
+        if (tracked_) {
+            ticks_.pop_back();
+        }
+        sparse_[index] = NONE;
+    }
+
+    /**
+     * Swap two rows of the dense array, keeping the sparse array in sync.
+     */
+    inline void Swap(uint32_t a, uint32_t b) {
+        if (a == b) {
+            return;
+        }
+        auto pa = data_.data() + a * size_;
+        auto pb = data_.data() + b * size_;
+        std::swap_ranges(pa, pa + size_, pb);
+        if (buffered_) {
+            auto fa = front_.data() + a * size_;
+            auto fb = front_.data() + b * size_;
+            std::swap_ranges(fa, fa + size_, fb);
+        }
+        if (tracked_) {
+            std::swap(ticks_[a], ticks_[b]);
+        }
+        std::swap(dense_[a], dense_[b]);
+        sparse_[dense_[a]] = a;
+        sparse_[dense_[b]] = b;
+    }
+
+    /**
+     * Get the dense row of the entity at the specified index.
+     * The entity must have a component in the pool.
+     */
+    inline uint32_t Row(Entity::Index index) const {
+        return sparse_[index];
+    }
+
+    /**
+     * Get a pointer to the component of the entity at the specified index.
+     * The entity must have a component in the pool.
+     */
+    inline void *Get(Entity::Index index) const {
+        return const_cast<char *>(data_.data()) + sparse_[index] * size_;
+    }
+
+    /**
+     * Get the number of live components in the pool.
+     */
+    inline uint64_t Size() const {
+        return dense_.size();
+    }
+
+    /**
+     * Get the entity indices that own the live components, in dense order.
+     */
+    inline const Entity::Index *Entities() const {
+        return dense_.data();
+    }
+
+    /**
+     * Get a pointer to the first live component in the pool.
+     */
+    inline void *Data() const {
+        return const_cast<char *>(data_.data());
+    }
+
+    /**
+     * Enable the front buffer: a read-only copy of the components, kept in
+     * the same rows as the live ones, that only changes when the buffers are
+     * swapped. Threads can read it while the live components are written.
+     */
+    inline void DoubleBuffer() {
+        if (!buffered_) {
+            buffered_ = true;
+            front_ = data_;
+        }
+    }
+
+    /**
+     * Check if the pool has a front buffer.
+     */
+    inline bool IsDoubleBuffered() const {
+        return buffered_;
+    }
+
+    /**
+     * Publish the live components to the front buffer. The live components
+     * are copied rather than exchanged, so that systems keep updating the
+     * latest state.
+     */
+    inline void SwapBuffers() {
+        if (buffered_) {
+            std::memcpy(front_.data(), data_.data(), data_.size());
+        }
+    }
+
+    /**
+     * Publish the live component of the entity at the specified index only,
+     * e.g. when it has just been added.
+     */
+    inline void SwapBuffers(Entity::Index index) {
+        if (buffered_) {
+            auto offset = sparse_[index] * size_;
+            std::memcpy(front_.data() + offset, data_.data() + offset, size_);
+        }
+    }
+
+    /**
+     * Reserve memory for rows more components, and sparse slots for entity
+     * indices below the specified one, so that adding them doesn't allocate.
+     */
+    inline void Reserve(uint64_t rows, Entity::Index indices) {
+        if (sparse_.size() < indices) {
+            sparse_.resize(indices, NONE);
+        }
+        dense_.reserve(dense_.size() + rows);
+        data_.reserve(data_.size() + rows * size_);
+        if (buffered_) {
+            front_.reserve(data_.capacity());
+        }
+        if (tracked_) {
+            ticks_.reserve(dense_.capacity());
+        }
+    }
+
+    /**
+     * Get a pointer to the front buffer copy of the component of the entity
+     * at the specified index. The pool must be double buffered and the
+     * entity must have a component in the pool.
+     */
+    inline const void *GetFront(Entity::Index index) const {
+        return front_.data() + sparse_[index] * size_;
+    }
+
+    /**
+     * Get the size of a component in bytes.
+     */
+    inline uint64_t ComponentSize() const {
+        return size_;
+    }
+
+    /**
+     * Get the packed row per entity index, NONE for the indices without a
+     * component. The indices past the end have none either.
+     */
+    inline Span<const uint32_t> Rows() const {
+        return sparse_;
+    }
+
+    /**
+     * Replace the contents of the pool with packed rows of components, the
+     * entity index per row and the row per entity index, e.g. read from a
+     * checkpoint. The front buffer, if any, is published with them.
+     */
+    inline void Assign(const char *data, const Entity::Index *dense, uint64_t rows,
+                       const uint32_t *sparse, uint64_t indices) {
+        data_.assign(data, data + rows * size_);
+        dense_.assign(dense, dense + rows);
+        sparse_.assign(sparse, sparse + indices);
+        if (buffered_) {
+            front_ = data_;
+        }
+        if (tracked_) {
+            ticks_.assign(rows, tick_);
+        }
+    }
+
+    /**
+     * Remove all components, keeping the front buffer and the change ticks
+     * enabled if they are.
+     */
+    inline void Clear() {
+        data_.clear();
+        front_.clear();
+        dense_.clear();
+        sparse_.clear();
+        ticks_.clear();
+    }
+
+    /**
+     * Remove all components like Clear, and return the memory of the rows to
+     * the allocator, e.g. before an Arena is reset.
+     */
+    inline void Release() {
+        Clear();
+        data_.release();
+        front_.release();
+    }
+
+    /**
+     * Track the tick at which every component last changed: when it was
+     * added, or marked with Touch. The components already in the pool
+     * change at the current tick.
+     */
+    inline void TrackChanges() {
+        if (!tracked_) {
+            tracked_ = true;
+            ticks_.assign(dense_.size(), tick_);
+        }
+    }
+
+    /**
+     * Check if the pool tracks the ticks at which its components change.
+     */
+    inline bool IsTracked() const {
+        return tracked_;
+    }
+
+    /**
+     * Set the current tick, which components added or touched from now on
+     * change at.
+     */
+    inline void SetTick(uint32_t tick) {
+        tick_ = tick;
+    }
+
+    /**
+     * Mark the component of the entity at the specified index as changed at
+     * the current tick, if the pool tracks changes. The entity must have a
+     * component in the pool.
+     */
+    inline void Touch(Entity::Index index) {
+        if (tracked_) {
+            ticks_[sparse_[index]] = tick_;
+        }
+    }
+
+    /**
+     * Get the tick at which the component of the entity at the specified
+     * index last changed. Components of untracked pools always changed at
+     * the current tick.
+     */
+    inline uint32_t ChangedAt(Entity::Index index) const {
+        return tracked_ ? ticks_[sparse_[index]] : tick_;
+    }
+
+    /**
+     * Get the change tick per packed row, or nullptr if the pool doesn't
+     * track changes. Writers can mark rows directly.
+     */
+    inline uint32_t *Ticks() {
+        return tracked_ ? ticks_.data() : nullptr;
+    }
+
+private:
+    uint64_t size_{ 0 };
+    Component::Info info_{};
+    bool buffered_{ false };
+    bool  tracked_{ false };
+    uint32_t tick_{ 0 };
+    Buffer                     data_{};   // components, packed
+    Buffer                    front_{};   // published copy of data_, if buffered
+    std::vector<Entity::Index> dense_{};  // entity index per packed row
+    std::vector<uint32_t>     sparse_{};  // packed row per entity index
+    std::vector<uint32_t>      ticks_{};  // change tick per packed row, if tracked
+};
+
+//=========================
+// Scene
+//=========================
+class Scene {
+public:
+    /**
+     * EntityPack holds an entity ID and a component mask that represents which
+     * components the entity has.
+     */
+    struct EntityPack {
+        Entity::Id      id_{ static_cast<Entity::Id>(-1) };
+        ComponentMask mask_{ };
+    };
+
+    /**
+     * GroupPack describes a set of component types whose pools are owned by
+     * the group. Entities having all of them are kept in the first size_ rows
+     * of every owned pool, in the same order, so their components can be read
+     * as packed columns.
+     */
+    struct GroupPack {
+        ComponentMask              mask_{ };
+        std::vector<Component::Id>  ids_{ };
+        uint64_t                   size_{ 0 };
+    };
+
+    Scene() = default;
+
+    /**
+     * Create a scene whose pools allocate their rows from an allocator, e.g.
+     * an Arena, which must outlive the scene.
+     */
+    explicit Scene(Allocator *allocator) : allocator_(allocator) {}
+
+    /**
+     * Create a new entity. The entity is either created by resuing an index
+     * from the freelist or by creating a new ID.
+     */
+    Entity::Id NewEntity() {
+        if (!freelist_.empty()) {
+            auto  i = freelist_.back(); freelist_.pop_back();
+            auto id = Entity::NewId(i, Entity::GetVersion(entities_[i].id_));
+            entities_[i].id_ = id;
+            return id;
+        }
+        if (entities_.size() >= Entity::INVALID_INDEX) {
+            throw;
+        }
+        auto id = Entity::NewId(Entity::Index(entities_.size()), 0);
+        entities_.emplace_back(EntityPack{ id, ComponentMask() });
+        return id;
+    }
+
+    /**
+     * Create count entities, each with a copy of every prototype component.
+     * Memory is reserved once for the whole batch. The returned IDs stay
+     * valid until the next call.
+     */
+    template<class... ComponentTypes>
+    Span<const Entity::Id> CreateBatch(uint64_t count, const ComponentTypes &... prototype) {
+        batch_.clear();
+        batch_.reserve(count);
+        auto reused = std::min<uint64_t>(count, freelist_.size());
+        entities_.reserve(entities_.size() + count - reused);
+        for (uint64_t n = 0; n < count; n++) {
+            batch_.push_back(NewEntity());
+        }
+        if (count == 0) {
+            return batch_;
+        }
+
+        // Every index of the batch is below the end of the entities
+        auto indices = static_cast<Entity::Index>(entities_.size());
+        ComponentMask mask;
+        (AddBatch(prototype, count, indices, mask), ...);
+        for (auto id : batch_) {
+            auto i = Entity::GetIndex(id);
+            entities_[i].mask_ |= mask;
+            for (auto &group : groups_) {
+                if ((group->mask_ & mask).any()) {
+                    Enter(*group, i);
+                }
+            }
+        }
+        return batch_;
+    }
+
+    /**
+     * Remove a batch of entities, e.g. the ones returned by CreateBatch.
+     */
+    void DestroyBatch(Span<const Entity::Id> ids) {
+        freelist_.reserve(freelist_.size() + ids.size());
+        for (auto id : ids) {
+            RemoveEntity(id);
+        }
+    }
+
+    /**
+     * Remove an entity. The entity's ID is invalidated and added to the
+     * freelist, and all its components are removed.
+     */
+    void RemoveEntity(Entity::Id id) {
+        auto i = Entity::GetIndex(id);
+        for (auto &group : groups_) {
+            Leave(*group, i);
+        }
+        for (Component::Id cid = 0; cid < MAX_COMPONENTS; cid++) {
+            if (entities_[i].mask_.test(cid)) {
+                pools_[cid]->Remove(i);
+            }
+        }
+        entities_[i].id_ = Entity::NewId(
+            Entity::INVALID_INDEX,
+            Entity::GetVersion(id) + 1
+        );
+        entities_[i].mask_.reset();
+        freelist_.push_back(i);
+    }
+
+    /**
+     * Check if an entity ID refers to a live entity, i.e. it hasn't been
+     * removed since it was created.
+     */
+    bool IsAlive(Entity::Id id) const {
+        auto i = Entity::GetIndex(id);
+        return i < entities_.size() && entities_[i].id_ == id;
+    }
+
+    /**
+     * Check if an entity has a component of a specific type.
+     */
+    template<class T>
+    bool HasComponent(Entity::Id id) {
+        auto   i = Entity::GetIndex(id);
+        auto cid = Component::GetId<T>();
+        return entities_[i].mask_.test(cid);
+    }
+
+    /**
+     * Add a component to an entity. The component is created in the pool
+     * corresponding to the component type.
+     */
+    template<class T, typename... Args>
+    T *AddComponent(Entity::Id id, Args&&... args) {
+        auto   i = Entity::GetIndex(id);
+        auto cid = Component::GetId<T>();
+        auto &pool = Pool<T>();
+        auto component = new (pool.Add(i)) T(std::forward<Args>(args)...);
+        pool.SwapBuffers(i);
+        entities_[i].mask_.set(cid);
+        for (auto &group : groups_) {
+            if (group->mask_.test(cid) && Enter(*group, i)) {
+                component = static_cast<T *>(pools_[cid]->Get(i));
+            }
+        }
+        return component;
+    }
+
+    /**
+     * Remove a component from an entity.
+     */
+    template<class T>
+    void RemoveComponent(Entity::Id id) {
+        auto   i = Entity::GetIndex(id);
+        auto cid = Component::GetId<T>();
+        if (!HasComponent<T>(id)) {
+            throw;
+        }
+        if (entities_[i].id_ != id) {
+            throw;
+        }
+        for (auto &group : groups_) {
+            if (group->mask_.test(cid)) {
+                Leave(*group, i);
+            }
+        }
+        pools_[cid]->Remove(i);
+        entities_[i].mask_.reset(cid);
+    }
+
+    /**
+     * Remove every component of a live entity but the ones whose types are
+     * in a mask, whether the types are known here or not.
+     */
+    void RemoveComponentsExcept(Entity::Id id, const ComponentMask &keep) {
+        if (!IsAlive(id)) {
+            return;
+        }
+        auto i = Entity::GetIndex(id);
+        for (Component::Id cid = 0; cid < MAX_COMPONENTS; cid++) {
+            if (!entities_[i].mask_.test(cid) || keep.test(cid)) {
+                continue;
+            }
+            for (auto &group : groups_) {
+                if (group->mask_.test(cid)) {
+                    Leave(*group, i);
+                }
+            }
+            pools_[cid]->Remove(i);
+            entities_[i].mask_.reset(cid);
+        }
+    }
+
+    /**
+     * Get a component from an entity.
+     */
+    template<class T>
+    T *GetComponent(Entity::Id id) {
+        auto   i = Entity::GetIndex(id);
+        auto cid = Component::GetId<T>();
+        if (!HasComponent<T>(id)) {
+            throw;
+        }
+        if (entities_[i].id_ != id) {
+            throw;
+        }
+        return static_cast<T *>(pools_[cid]->Get(i));
+    }
+
+    /**
+     * Get the front buffer copy of a component of a double-buffered type, as
+     * of the last SwapBuffers. Returns nullptr if the entity doesn't have the
+     * component, so that it can be called from parallel systems.
+     */
+    template<class T>
+    const T *GetFrontComponent(Entity::Id id) const {
+        auto   i = Entity::GetIndex(id);
+        auto cid = Component::GetId<T>();
+        if (entities_.size() <= i || entities_[i].id_ != id ||
+            !entities_[i].mask_.test(cid) || !pools_[cid]->IsDoubleBuffered()) {
+            return nullptr;
+        }
+        return static_cast<const T *>(pools_[cid]->GetFront(i));
+    }
+
+    /**
+     * Keep a front buffer for the components of a specific type. Systems
+     * running in parallel read the front buffer with GetFrontComponent,
+     * which only changes when SwapBuffers is called, e.g. once per tick.
+     */
+    template<class T>
+    void DoubleBuffer() {
+        Pool<T>().DoubleBuffer();
+    }
+
+    /**
+     * Publish the components of every double-buffered type to their front
+     * buffers. Must not run at the same time as systems that read them.
+     */
+    void SwapBuffers() {
+        for (auto &pool : pools_) {
+            if (pool != nullptr) {
+                pool->SwapBuffers();
+            }
+        }
+    }
+
+    /**
+     * Track the tick at which the components of a specific type change, so
+     * that views can skip the ones that didn't, see SceneView::ChangedSince.
+     * Systems writing them mark them with MarkChanged.
+     */
+    template<class T>
+    void TrackChanges() {
+        Pool<T>().TrackChanges();
+    }
+
+    /**
+     * Mark a component of an entity as changed at the current tick. Does
+     * nothing for untracked types. Different entities can be marked from
+     * different threads.
+     */
+    template<class T>
+    void MarkChanged(Entity::Id id) {
+        if (!HasComponent<T>(id)) {
+            throw;
+        }
+        pools_[Component::GetId<T>()]->Touch(Entity::GetIndex(id));
+    }
+
+    /**
+     * Get the current tick.
+     */
+    uint32_t GetTick() const {
+        return tick_;
+    }
+
+    /**
+     * Advance the current tick, e.g. at the start of every simulation step.
+     */
+    void NextTick() {
+        tick_++;
+        for (auto &pool : pools_) {
+            if (pool != nullptr) {
+                pool->SetTick(tick_);
+            }
+        }
+    }
+
+    /**
+     * Get a const reference to the vector of entities.
+     */
+    const std::vector<EntityPack> &GetEntities() const {
+        return entities_;
+    }
+
+    /**
+     * Get the pool for a component ID, or nullptr if no component of that
+     * type has been added yet.
+     */
+    ComponentPool *GetPool(Component::Id cid) const {
+        return cid < MAX_COMPONENTS ? pools_[cid].get() : nullptr;
+    }
+
+    /**
+     * Get the pool for a component type, creating it and registering the
+     * type on first use. The pools are indexed by ID in a fixed array, so
+     * that for types with ECS_COMPONENT_ID the lookup is a constant offset.
+     */
+    template<class T>
+    ComponentPool &Pool() {
+        auto cid = Component::GetId<T>();
+        if constexpr (!Component::Traits<T>::STATIC) {
+            if (MAX_COMPONENTS <= cid) {
+                throw;
+            }
+        }
+        auto &pool = pools_[cid];
+        if (pool == nullptr) {
+            pool = std::make_unique<ComponentPool>(Component::InfoOf<T>(), allocator_);
+            pool->SetTick(tick_);
+            ComponentRegistry::Instance().Register<T>();
+        }
+        return *pool;
+    }
+
+    /**
+     * Get a const reference to the indices of the removed entities, which
+     * NewEntity reuses from the back.
+     */
+    const std::vector<Entity::Index> &GetFreelist() const {
+        return freelist_;
+    }
+
+    /**
+     * Replace the entities and the freelist, e.g. with the ones of a
+     * checkpoint. Every pool is cleared, then restore is called with the
+     * scene to fill the pools of the components the entities have, e.g. with
+     * ComponentPool::Assign. The groups are sorted again afterwards.
+     */
+    template<class Func>
+    void Restore(Span<const EntityPack> entities, Span<const Entity::Index> freelist,
+                 Func &&restore) {
+        for (auto &pool : pools_) {
+            if (pool != nullptr) {
+                pool->Clear();
+            }
+        }
+        entities_.assign(entities.begin(), entities.end());
+        freelist_.assign(freelist.begin(), freelist.end());
+        restore(*this);
+
+        for (auto &group : groups_) {
+            group->size_ = 0;
+            for (Entity::Index i = 0; i < entities_.size(); i++) {
+                if (Entity::IsValid(entities_[i].id_)) {
+                    Enter(*group, i);
+                }
+            }
+        }
+    }
+
+    /**
+     * Remove every entity and return the memory of the pools to the
+     * allocator, keeping the pools' double buffers, change tracking and
+     * groups, e.g. to reset the scene's Arena before the next run. The IDs
+     * of the removed entities aren't invalidated and may be reused.
+     */
+    void Clear() {
+        for (auto &pool : pools_) {
+            if (pool != nullptr) {
+                pool->Release();
+            }
+        }
+        for (auto &group : groups_) {
+            group->size_ = 0;
+        }
+        entities_.clear();
+        freelist_.clear();
+        batch_.clear();
+    }
+
+    /**
+     * Get the allocator of the pools, or nullptr for the heap.
+     */
+    Allocator *GetAllocator() const {
+        return allocator_;
+    }
+
+    /**
+     * Get the group that owns the pools of the specified component types,
+     * creating it on first use. Creating a group sorts the entities that
+     * already have all the components into the leading rows of the pools.
+     * A pool can be owned by only one group.
+     */
+    template<class... ComponentTypes>
+    const GroupPack *Group() {
+        static_assert(sizeof...(ComponentTypes) != 0);
+        ComponentMask mask;
+        Component::Id ids[] = { Component::GetId<ComponentTypes>() ... };
+        for (auto cid : ids) {
+            mask.set(cid);
+        }
+        for (auto &group : groups_) {
+            if (group->mask_ == mask) {
+                return group.get();
+            }
+            if ((group->mask_ & mask).any()) {
+                throw;
+            }
+        }
+
+        auto group = std::make_unique<GroupPack>();
+        group->mask_ = mask;
+        group->ids_.assign(std::begin(ids), std::end(ids));
+        std::vector<Entity::Index> members;
+        for (Entity::Index i = 0; i < entities_.size(); i++) {
+            if (Entity::IsValid(entities_[i].id_) &&
+                (entities_[i].mask_ & mask) == mask) {
+                members.push_back(i);
+            }
+        }
+        for (auto i : members) {
+            Enter(*group, i);
+        }
+        groups_.push_back(std::move(group));
+        return groups_.back().get();
+    }
+
+private:
+    /**
+     * Add a copy of a prototype component to every entity of the batch.
+     */
+    template<class T>
+    void AddBatch(const T &prototype, uint64_t count, Entity::Index indices,
+                  ComponentMask &mask) {
+        auto &pool = Pool<T>();
+        pool.Reserve(count, indices);
+        for (auto id : batch_) {
+            auto i = Entity::GetIndex(id);
+            if constexpr (std::is_trivially_copyable<T>::value) {
+                std::memcpy(pool.Add(i), &prototype, sizeof(T));
+            } else {
+                new (pool.Add(i)) T(prototype);
+            }
+            pool.SwapBuffers(i);
+        }
+        mask.set(Component::GetId<T>());
+    }
+
+    /**
+     * Check if the entity at the specified index is in the leading rows of
+     * the group.
+     */
+    bool InGroup(const GroupPack &group, Entity::Index i) const {
+        return (entities_[i].mask_ & group.mask_) == group.mask_ &&
+               pools_[group.ids_[0]]->Row(i) < group.size_;
+    }
+
+    /**
+     * Move the entity at the specified index into the group if it has all
+     * the group's components. Returns true if rows were moved.
+     */
+    bool Enter(GroupPack &group, Entity::Index i) {
+        if ((entities_[i].mask_ & group.mask_) != group.mask_ || InGroup(group, i)) {
+            return false;
+        }
+        for (auto cid : group.ids_) {
+            auto &pool = pools_[cid];
+            pool->Swap(pool->Row(i), static_cast<uint32_t>(group.size_));
+        }
+        group.size_++;
+        return true;
+    }
+
+    /**
+     * Move the entity at the specified index out of the group, if it is in.
+     */
+    void Leave(GroupPack &group, Entity::Index i) {
+        if (!InGroup(group, i)) {
+            return;
+        }
+        group.size_--;
+        for (auto cid : group.ids_) {
+            auto &pool = pools_[cid];
+            pool->Swap(pool->Row(i), static_cast<uint32_t>(group.size_));
+        }
+    }
+
+    std::vector<EntityPack>    entities_{};
+    std::vector<Entity::Index> freelist_{};
+    std::array<std::unique_ptr<ComponentPool>, MAX_COMPONENTS> pools_{};
+    std::vector<std::unique_ptr<GroupPack>>                   groups_{};
+    std::vector<Entity::Id>                                    batch_{};  // IDs of the last CreateBatch
+    uint32_t                                                    tick_{ 0 };
+    Allocator                                              *allocator_{ nullptr };
+};
+
+//=========================
+// CommandBuffer
+//=========================
+/**
+ * CommandBuffer records structural changes, i.e. spawning and removing
+ * entities and adding and removing components, to apply them later to a
+ * scene, e.g. after the views iterating it are done. Components are copied
+ * into the buffer, so they must be trivially copyable.
+ */
+class CommandBuffer {
+public:
+    /**
+     * Record the creation of an entity with the specified components.
+     */
+    template<class... ComponentTypes>
+    void Spawn(const ComponentTypes &... components) {
+        auto offset = data_.size();
+        (Write(components), ...);
+        commands_.push_back(Command{ SPAWN, 0, commands_.size(), offset, &SpawnApply<ComponentTypes...> });
+    }
+
+    /**
+     * Record the removal of an entity.
+     */
+    void Despawn(Entity::Id id) {
+        commands_.push_back(Command{ DESPAWN, id, commands_.size(), 0, &DespawnApply });
+    }
+
+    /**
+     * Record adding a component to an entity, or replacing its component.
+     */
+    template<class T>
+    void Add(Entity::Id id, const T &component) {
+        auto offset = data_.size();
+        Write(component);
+        commands_.push_back(Command{ CHANGE, id, commands_.size(), offset, &AddApply<T> });
+    }
+
+    /**
+     * Record removing a component from an entity.
+     */
+    template<class T>
+    void Remove(Entity::Id id) {
+        commands_.push_back(Command{ CHANGE, id, commands_.size(), 0, &RemoveApply<T> });
+    }
+
+    /**
+     * Get the number of recorded commands.
+     */
+    uint64_t Size() const {
+        return commands_.size();
+    }
+
+    /**
+     * Apply the recorded commands to a scene and clear the buffer. See
+     * CommandQueue::Playback for the order.
+     */
+    void Playback(Scene &scene) {
+        CommandBuffer *buffers[] = { this };
+        Playback(scene, buffers, 1);
+    }
+
+    /**
+     * Apply the commands of several buffers in one sorted pass and clear them.
+     * The changes of an entity are applied in the order they were recorded
+     * in each buffer, the buffers in order, then the entities are removed,
+     * then the new ones are spawned. Commands on entities that are no longer
+     * alive are dropped.
+     */
+    static void Playback(Scene &scene, CommandBuffer *const *buffers, uint64_t count) {
+        struct Entry {
+            const Command *command;
+            const char       *data;
+            uint64_t       buffer;
+        };
+        std::vector<Entry> entries;
+        for (uint64_t b = 0; b < count; b++) {
+            for (auto &command : buffers[b]->commands_) {
+                entries.push_back(Entry{ &command, buffers[b]->data_.data(), b });
+            }
+        }
+        std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+            auto ka = std::make_tuple(a.command->kind, Entity::GetIndex(a.command->id), a.buffer, a.command->sequence);
+            auto kb = std::make_tuple(b.command->kind, Entity::GetIndex(b.command->id), b.buffer, b.command->sequence);
+            return ka < kb;
+        });
+        for (auto &entry : entries) {
+            auto command = entry.command;
+            if (command->kind != SPAWN && !scene.IsAlive(command->id)) {
+                continue;
+            }
+            command->apply(scene, command->id, entry.data + command->offset);
+        }
+        for (uint64_t b = 0; b < count; b++) {
+            buffers[b]->commands_.clear();
+            buffers[b]->data_.clear();
+        }
+    }
+
+private:
+    enum Kind : uint8_t { CHANGE, DESPAWN, SPAWN };
+
+    typedef void (*Apply)(Scene &scene, Entity::Id id, const char *data);
+
+    struct Command {
+        Kind         kind;
+        Entity::Id     id;
+        uint64_t sequence;
+        uint64_t   offset;  // of the components in data_
+        Apply       apply;
+    };
+
+    template<class T>
+    void Write(const T &component) {
+        static_assert(std::is_trivially_copyable<T>::value);
+        auto offset = data_.size();
+        data_.resize(offset + sizeof(T));
+        std::memcpy(data_.data() + offset, &component, sizeof(T));
+    }
+
+    template<class T>
+    static T Read(const char *&data) {
+        alignas(T) char component[sizeof(T)];
+        std::memcpy(component, data, sizeof(T));
+        data += sizeof(T);
+        return *reinterpret_cast<T *>(component);
+    }
+
+    template<class... ComponentTypes>
+    static void SpawnApply(Scene &scene, Entity::Id, const char *data) {
+        auto id = scene.NewEntity();
+        (scene.AddComponent<ComponentTypes>(id, Read<ComponentTypes>(data)), ...);
+    }
+
+    static void DespawnApply(Scene &scene, Entity::Id id, const char *) {
+        scene.RemoveEntity(id);
+    }
+
+    template<class T>
+    static void AddApply(Scene &scene, Entity::Id id, const char *data) {
+        auto component = Read<T>(data);
+        if (scene.HasComponent<T>(id)) {
+            *scene.GetComponent<T>(id) = component;
+        } else {
+            scene.AddComponent<T>(id, component);
+        }
+    }
+
+    template<class T>
+    static void RemoveApply(Scene &scene, Entity::Id id, const char *) {
+        if (scene.HasComponent<T>(id)) {
+            scene.RemoveComponent<T>(id);
+        }
+    }
+
+    std::vector<Command> commands_{};
+    std::vector<char>        data_{};
+};
+
+/**
+ * CommandQueue gives every thread its own CommandBuffer, so that systems
+ * running in parallel record commands without locking, and plays all of
+ * them back at a sync point.
+ */
+class CommandQueue {
+public:
+    CommandQueue() = default;
+    CommandQueue(const CommandQueue &) = delete;
+    CommandQueue &operator=(const CommandQueue &) = delete;
+
+    /**
+     * Get the buffer of the calling thread.
+     */
+    CommandBuffer &Local() {
+        static thread_local Owner owner;
+        if (owner.queue != id_) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto thread = std::this_thread::get_id();
+            auto it = std::find(threads_.begin(), threads_.end(), thread);
+            if (it == threads_.end()) {
+                threads_.push_back(thread);
+                buffers_.push_back(std::make_unique<CommandBuffer>());
+                it = threads_.end() - 1;
+            }
+            owner = Owner{ id_, buffers_[it - threads_.begin()].get() };
+        }
+        return *owner.buffer;
+    }
+
+    /**
+     * Apply the commands of every thread to a scene in one sorted pass. Must
+     * not run at the same time as threads recording commands.
+     */
+    void Playback(Scene &scene) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<CommandBuffer *> buffers;
+        for (auto &buffer : buffers_) {
+            buffers.push_back(buffer.get());
+        }
+        CommandBuffer::Playback(scene, buffers.data(), buffers.size());
+    }
+
+private:
+    /**
+     * Cached buffer of the calling thread, for the last queue it used. Queues
+     * are told apart by id rather than address, which may be reused.
+     */
+    struct Owner {
+        uint64_t          queue{ 0 };
+        CommandBuffer   *buffer{ nullptr };
+    };
+
+    static uint64_t NewId() {
+        static std::atomic<uint64_t> counter(1);
+        return counter++;
+    }
+
+    uint64_t                                       id_{ NewId() };
+    std::mutex                                  mutex_{};
+    std::vector<std::thread::id>                threads_{};
+    std::vector<std::unique_ptr<CommandBuffer>> buffers_{};  // per thread
+};
+
+//=========================
+// Prefab
+//=========================
+/**
+ * Prefab is a recipe of components to create entities from, e.g.
+ *
+ *     ecs::Prefab<Transform, Move> prefab(Transform(...), Move(...));
+ *     auto ids = prefab.Instantiate(scene, 1000);
+ *
+ * Its mask and the bytes of components per instance are known at compile
+ * time. Trivially copyable components are copied into the pools with memcpy.
+ */
+template<class... ComponentTypes>
+class Prefab {
+public:
+    static_assert(sizeof...(ComponentTypes) != 0);
+
+    // Whether all component types have a compile-time ID, making Mask() a constant
+    static constexpr bool STATIC = (Component::Traits<ComponentTypes>::STATIC && ...);
+    // Bytes of components per instance, in the pools
+    static constexpr uint64_t BYTES = (sizeof(ComponentTypes) + ...);
+
+    /**
+     * Constructor. Takes the prototype of every component.
+     */
+    explicit Prefab(const ComponentTypes &... prototype) : prototype_(prototype...) {}
+
+    /**
+     * Get the mask of the components an instance has.
+     */
+    static ComponentMask Mask() {
+        return Component::MaskOf<ComponentTypes...>();
+    }
+
+    /**
+     * Get the prototype of a component, to change it between instantiations.
+     */
+    template<class T>
+    T &Get() {
+        return std::get<T>(prototype_);
+    }
+
+    /**
+     * Create count entities from the prefab. The returned IDs stay valid until
+     * the next call to Instantiate or Scene::CreateBatch.
+     */
+    Span<const Entity::Id> Instantiate(Scene &scene, uint64_t count) const {
+        return std::apply([&](const ComponentTypes &... prototype) {
+            return scene.CreateBatch(count, prototype...);
+        }, prototype_);
+    }
+
+private:
+    std::tuple<ComponentTypes...> prototype_;
+};
+
+/**
+ * SceneView allows to iterate over entities in a scene that have specific
+ * component types. The iteration is driven by the smallest pool among the
+ * component types, so its cost scales with the number of candidates rather
+ * than with the total number of entities.
+ */
+template<class... ComponentTypes>
+class SceneView {
+public:
+    /**
+     * Constructor.
+     */
+    SceneView(Scene &scene) : scene_(&scene) {
+        if (sizeof...(ComponentTypes) == 0) {
+            all_ = true;
+        } else {
+            Component::Id ids[] = { Component::GetId<ComponentTypes>() ... };
+            mask_ = Component::MaskOf<ComponentTypes...>();
+            for (size_t i = 0; i < sizeof...(ComponentTypes); i++) {
+                auto pool = scene.GetPool(ids[i]);
+                if (pool == nullptr) {
+                    // No entity can match, leave the view empty
+                    empty_ = true;
+                    break;
+                }
+                if (pool_ == nullptr || pool->Size() < pool_->Size()) {
+                    pool_ = pool;
+                }
+            }
+        }
+    }
+
+    /**
+     * Get a copy of the view that skips the entities whose component of
+     * type T, one of the view's types, last changed before a tick. E.g.
+     * ChangedSince<Transform>(scene.GetTick() - 1) visits the entities that
+     * moved in the previous tick or this one. Components of untracked types
+     * always count as changed.
+     */
+    template<class T>
+    SceneView ChangedSince(uint32_t tick) const {
+        static_assert((std::is_same<T, ComponentTypes>::value || ...));
+        auto view = *this;
+        auto pool = scene_->GetPool(Component::GetId<T>());
+        if (pool != nullptr && pool->IsTracked()) {
+            view.changed_ = pool;
+            view.since_ = tick;
+        }
+        return view;
+    }
+
+    /**
+     * Iterator allows to iterate over entities in a SceneView. The position
+     * is an index into the scene's entities when the view has no component
+     * types, or a row of the driving pool otherwise.
+     */
+    struct Iterator {
+        Iterator(const Scene::EntityPack *entities, const Entity::Index *rows,
+                 uint64_t size, uint64_t index, ComponentMask mask, bool all,
+                 const ComponentPool *changed = nullptr, uint32_t since = 0)
+            : entities_(entities), rows_(rows), size_(size),
+              index_(index), mask_(mask), all_(all),
+              changed_(changed), since_(since) {}
+
+        Entity::Id operator*() const {
+            return Pack().id_;
+        }
+
+        bool operator==(const Iterator &other) const {
+            return index_ == other.index_;
+        }
+
+        bool operator!=(const Iterator &other) const {
+            return index_ != other.index_;
+        }
+
+        const Scene::EntityPack &Pack() const {
+            return all_ ? entities_[index_] : entities_[rows_[index_]];
+        }
+
+        bool IsValid() const {
+            if (all_) {
+                return Entity::IsValid(entities_[index_].id_);
+            }
+            // Pools only hold live entities, so a single component view
+            // never needs the mask test.
+            return (sizeof...(ComponentTypes) == 1 ||
+                    mask_ == (mask_ & Pack().mask_)) &&
+                   (changed_ == nullptr || since_ <= changed_->ChangedAt(rows_[index_]));
+        }
+
+        Iterator &operator++() {
+            while (++index_ < size_ && !IsValid());
+            return *this;
+        }
+
+        const Scene::EntityPack *entities_{ nullptr };
+        const Entity::Index         *rows_{ nullptr };
+        uint64_t                     size_{ 0 };
+        uint64_t                    index_{ 0 };
+        ComponentMask                mask_{ };
+        bool                          all_{ false };
+        const ComponentPool       *changed_{ nullptr };
+        uint32_t                    since_{ 0 };
+    };
+
+    const Iterator begin() const {
+        auto it = Iterator(scene_->GetEntities().data(), Rows(), Size(), 0, mask_, all_, changed_, since_);
+        if (it.index_ < it.size_ && !it.IsValid()) {
+            ++it;
+        }
+        return it;
+    }
+
+    const Iterator end() const {
+        return Iterator(scene_->GetEntities().data(), Rows(), Size(), Size(), mask_, all_, changed_, since_);
+    }
+
+    /**
+     * Invoke a function for every matching entity with references to its
+     * components, as func(T &...) or func(Entity::Id, T &...). The pools are
+     * looked up once for the whole view and the components are read without
+     * the checks of Scene::GetComponent. The function must not add or remove
+     * components or entities.
+     */
+    template<class Func>
+    void Each(Func &&func) const {
+        Each(0, Size(), std::forward<Func>(func));
+    }
+
+    /**
+     * Invoke a function like Each, but only for the rows [first, last) of the
+     * view. Disjoint ranges can be processed on different threads.
+     */
+    template<class Func>
+    void Each(uint64_t first, uint64_t last, Func &&func) const {
+        static_assert(sizeof...(ComponentTypes) != 0);
+        if (empty_) {
+            return;
+        }
+        ComponentPool *pools[] = { scene_->GetPool(Component::GetId<ComponentTypes>()) ... };
+        auto entities = scene_->GetEntities().data();
+        auto rows = pool_->Entities();
+        const auto mask = Component::MaskOf<ComponentTypes...>();
+        for (uint64_t row = first; row < last; row++) {
+            const auto &pack = entities[rows[row]];
+            if (sizeof...(ComponentTypes) != 1 && mask != (mask & pack.mask_)) {
+                continue;
+            }
+            if (changed_ != nullptr && changed_->ChangedAt(rows[row]) < since_) {
+                continue;
+            }
+            Invoke(func, pack.id_, rows[row], pools, std::index_sequence_for<ComponentTypes...>{});
+        }
+    }
+
+    /**
+     * Get the number of rows the view iterates, which is an upper bound of
+     * the number of matching entities.
+     */
+    uint64_t Size() const {
+        if (all_) {
+            return scene_->GetEntities().size();
+        }
+        return empty_ ? 0 : pool_->Size();
+    }
+
+private:
+    template<class Func, size_t... I>
+    static void Invoke(Func &func, Entity::Id id, Entity::Index i,
+                       ComponentPool *const *pools, std::index_sequence<I...>) {
+        if constexpr (std::is_invocable_v<Func &, Entity::Id, ComponentTypes &...>) {
+            func(id, *static_cast<ComponentTypes *>(pools[I]->Get(i)) ...);
+        } else {
+            func(*static_cast<ComponentTypes *>(pools[I]->Get(i)) ...);
+        }
+    }
+
+    const Entity::Index *Rows() const {
+        return pool_ != nullptr ? pool_->Entities() : nullptr;
+    }
+
+    Scene         *scene_{ nullptr };
+    ComponentPool  *pool_{ nullptr };
+    bool             all_{ false };
+    bool           empty_{ false };
+    ComponentMask   mask_{ };
+    const ComponentPool *changed_{ nullptr };  // filter by change tick, if set
+    uint32_t               since_{ 0 };
+};
+
+/**
+ * Snapshot holds a read-only copy of the components of one type, on the
+ * heap, e.g. to keep it after the scene is cleared. Systems running in
+ * parallel read other entities from the front buffers instead, see
+ * Scene::DoubleBuffer.
+ */
+template<class T>
+class Snapshot {
+public:
+    /**
+     * Copy the components of the scene. The storage is reused between
+     * captures.
+     */
+    void Capture(const Scene &scene) {
+        auto pool = scene.GetPool(Component::GetId<T>());
+        if (pool != nullptr) {
+            pool_ = *pool;
+        } else {
+            pool_ = ComponentPool(Component::InfoOf<T>());
+        }
+    }
+
+    /**
+     * Get the captured component of an entity, or nullptr if the entity
+     * didn't have one.
+     */
+    const T *Get(Entity::Id id) const {
+        auto i = Entity::GetIndex(id);
+        return pool_.Has(i) ? static_cast<const T *>(pool_.Get(i)) : nullptr;
+    }
+
+private:
+    ComponentPool pool_{ Component::InfoOf<T>() };
+};
+
+/**
+ * ChunkView allows to iterate over the entities of a group in chunks of at
+ * most CHUNK_SIZE entities. Each chunk exposes one packed column per component
+ * type, so systems can stream through the components linearly. The group is
+ * created on first use.
+ */
+template<class... ComponentTypes>
+class ChunkView {
+public:
+    /**
+     * Chunk holds packed columns of components for consecutive group rows.
+     */
+    struct Chunk {
+        /**
+         * Get the number of entities in the chunk.
+         */
+        uint64_t Size() const {
+            return size_;
+        }
+
+        /**
+         * Get the column of the specified component type.
+         */
+        template<class T>
+        T *Get() const {
+            return std::get<T *>(columns_);
+        }
+
+        /**
+         * Get the entity indices of the rows in the chunk.
+         */
+        const Entity::Index *Entities() const {
+            return entities_;
+        }
+
+        /**
+         * Get the group row of the first entity in the chunk, which is also
+         * its row in every owned pool.
+         */
+        uint64_t First() const {
+            return first_;
+        }
+
+        uint64_t                           size_{ 0 };
+        uint64_t                          first_{ 0 };
+        const Entity::Index           *entities_{ nullptr };
+        std::tuple<ComponentTypes *...> columns_{ };
+    };
+
+    /**
+     * Constructor.
+     */
+    ChunkView(Scene &scene) : scene_(&scene) {
+        group_ = scene.Group<ComponentTypes...>();
+    }
+
+    /**
+     * Iterator allows to iterate over chunks in a ChunkView.
+     */
+    struct Iterator {
+        Iterator(const ChunkView *view, uint64_t first)
+            : view_(view), first_(first) {}
+
+        Chunk operator*() const {
+            return view_->At(first_);
+        }
+
+        bool operator==(const Iterator &other) const {
+            return first_ == other.first_;
+        }
+
+        bool operator!=(const Iterator &other) const {
+            return first_ != other.first_;
+        }
+
+        Iterator &operator++() {
+            first_ = std::min(first_ + CHUNK_SIZE, view_->Size());
+            return *this;
+        }
+
+        const ChunkView *view_{ nullptr };
+        uint64_t        first_{ 0 };
+    };
+
+    const Iterator begin() const {
+        return Iterator(this, 0);
+    }
+
+    const Iterator end() const {
+        return Iterator(this, Size());
+    }
+
+    /**
+     * Get the number of entities in the group.
+     */
+    uint64_t Size() const {
+        return group_->size_;
+    }
+
+    /**
+     * Get the chunk that starts at the specified group row.
+     */
+    Chunk At(uint64_t first) const {
+        Chunk chunk;
+        chunk.size_ = std::min(CHUNK_SIZE, Size() - first);
+        chunk.first_ = first;
+        chunk.entities_ = Pool<ComponentTypes...>()->Entities() + first;
+        chunk.columns_ = std::make_tuple(
+            static_cast<ComponentTypes *>(Pool<ComponentTypes>()->Data()) + first ...
+        );
+        return chunk;
+    }
+
+private:
+    template<class T, class... Rest>
+    ComponentPool *Pool() const {
+        return scene_->GetPool(Component::GetId<T>());
+    }
+
+    Scene               *scene_{ nullptr };
+    const Scene::GroupPack *group_{ nullptr };
+};
+
+}  // ecs
+
+/**
+ * Give a component type a compile-time ID, below
+ * ecs::Component::STATIC_COMPONENTS and unique among the registered types.
+ * Use it in the global namespace, before the ID of the type is first used.
+ */
+#define ECS_COMPONENT_ID(Type, N)                               \
+    namespace ecs { namespace Component {                       \
+    template<>                                                  \
+    struct Traits<Type> {                                       \
+        static_assert((N) < STATIC_COMPONENTS,                  \
+                      "raise ECS_STATIC_COMPONENTS");           \
+        static constexpr bool STATIC = true;                    \
+        static constexpr Id ID = (N);                           \
+    };                                                          \
+    } }
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+namespace steering {
+namespace render {
+/**
+ * Camera maps the world to the screen: the world position at its center is
+ * drawn at the center of the viewport, and a world unit spans zoom pixels.
+ */
+struct Camera {
+    Camera() = default;
+    Camera(glm::vec2 center, glm::vec2 viewport, float zoom = 1.0f)
+        : center(center),
+          viewport(viewport),
+          zoom(zoom) {}
+
+    glm::vec2   center{ glm::vec2(0.0f) };  // world position
+    glm::vec2 viewport{ glm::vec2(0.0f) };  // size in pixels
+    float         zoom{ 1.0f };              // pixels per world unit
+
+    glm::vec2 ToScreen(glm::vec2 world) const {
+        return (world - center) * zoom + viewport * 0.5f;
+    }
+
+    glm::vec2 ToWorld(glm::vec2 screen) const {
+        return (screen - viewport * 0.5f) / zoom + center;
+    }
+
+    /**
+     * Get the corner of the visible part of the world with the smallest
+     * coordinates.
+     */
+    glm::vec2 Min() const {
+        return ToWorld(glm::vec2(0.0f));
+    }
+
+    /**
+     * Get the corner of the visible part of the world with the largest
+     * coordinates.
+     */
+    glm::vec2 Max() const {
+        return ToWorld(viewport);
+    }
+
+    /**
+     * Check if a circle in the world overlaps the viewport.
+     */
+    bool IsVisible(glm::vec2 position, float radius) const {
+        auto lo = Min() - radius;
+        auto hi = Max() + radius;
+        return lo.x <= position.x && position.x <= hi.x &&
+               lo.y <= position.y && position.y <= hi.y;
+    }
+
+    /**
+     * Zoom by a factor, keeping the world position under a screen position
+     * in place, e.g. under the mouse cursor.
+     */
+    void ZoomAt(glm::vec2 screen, float factor) {
+        auto anchor = ToWorld(screen);
+        zoom *= factor;
+        center += anchor - ToWorld(screen);
+    }
+};
+
+}  // render
+}  // steering
@@ -0,0 +1,346 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <ECS.h>
+
+namespace steering {
+namespace checkpoint {
+
+constexpr uint32_t MAGIC(0x4b435453);  // "STCK"
+constexpr uint32_t VERSION(1);
+// Every block starts at a multiple of this, so that a mapped file can be
+// read in place
+constexpr uint64_t ALIGNMENT(64);
+
+/**
+ * Header of a checkpoint file. The entity and mask layout are recorded, so
+ * that a file is only read by a build with the same ECS options.
+ */
+struct Header {
+    uint32_t    magic{ MAGIC };
+    uint32_t  version{ VERSION };
+    uint32_t   idSize{ sizeof(ecs::Entity::Id) };
+    uint32_t packSize{ sizeof(ecs::Scene::EntityPack) };
+    uint64_t entities{ 0 };
+    uint64_t freelist{ 0 };
+    uint64_t    pools{ 0 };
+};
+
+/**
+ * Header of the blocks of a pool: the packed rows of components, the entity
+ * index per row and the row per entity index.
+ */
+struct PoolHeader {
+    uint64_t      id{ 0 };  // component ID
+    uint64_t    size{ 0 };  // component size in bytes
+    uint64_t    rows{ 0 };
+    uint64_t indices{ 0 };
+};
+
+inline uint64_t Padded(uint64_t bytes) {
+    return (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+/**
+ * File is the read-only contents of a checkpoint file, memory mapped where
+ * the platform supports it and read into memory otherwise.
+ */
+class File {
+public:
+    explicit File(const std::string &path) {
+#if defined(__unix__) || defined(__APPLE__)
+        auto fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && 0 < st.st_size) {
+            auto map = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map != MAP_FAILED) {
+                ::madvise(map, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+                data_ = static_cast<const char *>(map);
+                size_ = static_cast<uint64_t>(st.st_size);
+            }
+        }
+        ::close(fd);
+#else
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in) {
+            return;
+        }
+        buffer_.resize(static_cast<size_t>(in.tellg()));
+        in.seekg(0);
+        if (in.read(buffer_.data(), buffer_.size())) {
+            data_ = buffer_.data();
+            size_ = buffer_.size();
+        }
+#endif
+    }
+
+    ~File() {
+#if defined(__unix__) || defined(__APPLE__)
+        if (data_ != nullptr) {
+            ::munmap(const_cast<char *>(data_), static_cast<size_t>(size_));
+        }
+#endif
+    }
+
+    File(const File &) = delete;
+    File &operator=(const File &) = delete;
+
+    /**
+     * Get the bytes of a block at an offset, or nullptr if the file is too
+     * short. The offset advances to the next block.
+     */
+    const char *Take(uint64_t &offset, uint64_t bytes) const {
+        if (size_ < offset || size_ - offset < bytes) {
+            return nullptr;
+        }
+        auto block = data_ + offset;
+        offset += Padded(bytes);
+        return block;
+    }
+
+    /**
+     * Get the bytes of a block of count elements of a size, or nullptr if
+     * the file is too short, or the block is larger than any file.
+     */
+    const char *Take(uint64_t &offset, uint64_t count, uint64_t size) const {
+        if (size != 0 && UINT64_MAX / size < count) {
+            return nullptr;
+        }
+        return Take(offset, count * size);
+    }
+
+private:
+    const char        *data_{ nullptr };
+    uint64_t           size_{ 0 };
+    std::vector<char> buffer_{};
+};
+
+}  // checkpoint
+
+/**
+ * Checkpoint saves and restores a scene in a versioned binary format: the
+ * entities, the freelist and the live rows of the pools of the component
+ * types, as contiguous blocks. Restoring maps the file and copies every
+ * block into the scene at once, without adding components one by one.
+ *
+ * The component types must be trivially copyable, and have the same IDs
+ * when the checkpoint is restored, e.g. with ECS_COMPONENT_ID. Groups and
+ * double buffers aren't saved; the scene restored into keeps its own.
+ */
+template<class... ComponentTypes>
+class Checkpoint {
+public:
+    static_assert((std::is_trivially_copyable<ComponentTypes>::value && ...));
+
+    /**
+     * Write a scene to a file. Returns false if the file can't be written,
+     * or if the scene has components of other types, which couldn't be
+     * restored.
+     */
+    static bool Save(const ecs::Scene &scene, const std::string &path) {
+        for (ecs::Component::Id cid = 0; cid < ecs::MAX_COMPONENTS; cid++) {
+            auto pool = scene.GetPool(cid);
+            if (pool != nullptr && pool->Size() != 0 && !Saved(cid)) {
+                return false;
+            }
+        }
+        std::ofstream out(path, std::ios::binary);
+        if (!out) {
+            return false;
+        }
+
+        auto &entities = scene.GetEntities();
+        auto &freelist = scene.GetFreelist();
+        checkpoint::Header header;
+        header.entities = entities.size();
+        header.freelist = freelist.size();
+        header.pools = sizeof...(ComponentTypes);
+        Write(out, &header, sizeof(header));
+        Write(out, entities.data(), entities.size() * sizeof(ecs::Scene::EntityPack));
+        Write(out, freelist.data(), freelist.size() * sizeof(ecs::Entity::Index));
+
+        (SavePool<ComponentTypes>(scene, out), ...);
+        return static_cast<bool>(out);
+    }
+
+    /**
+     * Replace the entities and components of a scene with the ones of a
+     * file. Returns false, leaving the scene unchanged, if the file can't be
+     * read, was written by another version or for other components, or is
+     * corrupt.
+     */
+    static bool Load(ecs::Scene &scene, const std::string &path) {
+        checkpoint::File file(path);
+        uint64_t offset = 0;
+        auto header = reinterpret_cast<const checkpoint::Header *>(file.Take(offset, sizeof(checkpoint::Header)));
+        checkpoint::Header expected;
+        if (header == nullptr || header->magic != expected.magic ||
+            header->version != expected.version || header->idSize != expected.idSize ||
+            header->packSize != expected.packSize || header->pools != sizeof...(ComponentTypes)) {
+            return false;
+        }
+        auto entities = file.Take(offset, header->entities, sizeof(ecs::Scene::EntityPack));
+        auto freelist = file.Take(offset, header->freelist, sizeof(ecs::Entity::Index));
+        if (entities == nullptr || freelist == nullptr) {
+            return false;
+        }
+
+        // Check every pool before changing the scene. They are saved in the
+        // order of the component types.
+        ecs::Component::Id ids[] = { ecs::Component::GetId<ComponentTypes>() ... };
+        uint64_t sizes[] = { sizeof(ComponentTypes) ... };
+        std::vector<Block> blocks;
+        for (uint64_t n = 0; n < header->pools; n++) {
+            Block block;
+            block.header = reinterpret_cast<const checkpoint::PoolHeader *>(
+                file.Take(offset, sizeof(checkpoint::PoolHeader)));
+            if (block.header == nullptr || block.header->id != ids[n] ||
+                block.header->size != sizes[n]) {
+                return false;
+            }
+            block.data   = file.Take(offset, block.header->rows, block.header->size);
+            block.dense  = file.Take(offset, block.header->rows, sizeof(ecs::Entity::Index));
+            block.sparse = file.Take(offset, block.header->indices, sizeof(uint32_t));
+            if (block.data == nullptr || block.dense == nullptr || block.sparse == nullptr) {
+                return false;
+            }
+            blocks.push_back(block);
+        }
+
+        ecs::Span<const ecs::Scene::EntityPack> packs(
+            reinterpret_cast<const ecs::Scene::EntityPack *>(entities), header->entities);
+        ecs::Span<const ecs::Entity::Index> free(
+            reinterpret_cast<const ecs::Entity::Index *>(freelist), header->freelist);
+        if (!Consistent(packs, free, blocks)) {
+            return false;
+        }
+        scene.Restore(packs, free, [&](ecs::Scene &restored) {
+            size_t n = 0;
+            (LoadPool<ComponentTypes>(restored, blocks[n++]), ...);
+        });
+        return true;
+    }
+
+private:
+    struct Block {
+        const checkpoint::PoolHeader *header{ nullptr };
+        const char                     *data{ nullptr };
+        const char                    *dense{ nullptr };
+        const char                   *sparse{ nullptr };
+    };
+
+    static bool Saved(ecs::Component::Id cid) {
+        return ((cid == ecs::Component::GetId<ComponentTypes>()) || ...);
+    }
+
+    /**
+     * Check that the entities, the freelist and the pools of a file agree
+     * with each other, so that a corrupt file can't make the restored scene
+     * index out of bounds: the live entities are at their own index, the
+     * freelist holds removed entities once, the dense and sparse arrays of
+     * every pool are inverses, and the masks match the pools.
+     */
+    static bool Consistent(ecs::Span<const ecs::Scene::EntityPack> entities,
+                           ecs::Span<const ecs::Entity::Index> freelist,
+                           const std::vector<Block> &blocks) {
+        auto count = entities.size();
+        ecs::ComponentMask saved;
+        for (auto &block : blocks) {
+            saved.set(block.header->id);
+        }
+        for (uint64_t i = 0; i < count; i++) {
+            auto &entity = entities[i];
+            auto valid = ecs::Entity::IsValid(entity.id_);
+            if ((valid && ecs::Entity::GetIndex(entity.id_) != i) || (!valid && entity.mask_.any()) ||
+                (entity.mask_ & saved) != entity.mask_) {
+                return false;
+            }
+        }
+
+        std::vector<bool> removed(count, false);
+        for (auto i : freelist) {
+            if (count <= i || ecs::Entity::IsValid(entities[i].id_) || removed[i]) {
+                return false;
+            }
+            removed[i] = true;
+        }
+
+        for (auto &block : blocks) {
+            auto rows    = block.header->rows;
+            auto indices = block.header->indices;
+            auto dense   = reinterpret_cast<const ecs::Entity::Index *>(block.dense);
+            auto sparse  = reinterpret_cast<const uint32_t *>(block.sparse);
+            if (count < indices) {
+                return false;
+            }
+            for (uint64_t r = 0; r < rows; r++) {
+                if (indices <= dense[r] || sparse[dense[r]] != r) {
+                    return false;
+                }
+            }
+            for (uint64_t i = 0; i < count; i++) {
+                auto member = i < indices && sparse[i] != ecs::ComponentPool::NONE;
+                if ((member && (rows <= sparse[i] || dense[sparse[i]] != i)) ||
+                    member != entities[i].mask_.test(block.header->id)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Write a block, padded to the alignment.
+     */
+    static void Write(std::ofstream &out, const void *data, uint64_t bytes) {
+        static const char zeros[checkpoint::ALIGNMENT] = {};
+        out.write(static_cast<const char *>(data), static_cast<std::streamsize>(bytes));
+        out.write(zeros, static_cast<std::streamsize>(checkpoint::Padded(bytes) - bytes));
+    }
+
+    template<class T>
+    static void SavePool(const ecs::Scene &scene, std::ofstream &out) {
+        checkpoint::PoolHeader header;
+        header.id = ecs::Component::GetId<T>();
+        header.size = sizeof(T);
+        auto pool = scene.GetPool(header.id);
+        if (pool == nullptr) {
+            Write(out, &header, sizeof(header));
+            return;
+        }
+        auto rows = pool->Rows();
+        header.rows = pool->Size();
+        header.indices = rows.size();
+        Write(out, &header, sizeof(header));
+        Write(out, pool->Data(), header.rows * sizeof(T));
+        Write(out, pool->Entities(), header.rows * sizeof(ecs::Entity::Index));
+        Write(out, rows.data(), rows.size() * sizeof(uint32_t));
+    }
+
+    template<class T>
+    static void LoadPool(ecs::Scene &scene, const Block &block) {
+        scene.Pool<T>().Assign(block.data,
+                               reinterpret_cast<const ecs::Entity::Index *>(block.dense),
+                               block.header->rows,
+                               reinterpret_cast<const uint32_t *>(block.sparse),
+                               block.header->indices);
+    }
+};
+
+}  // steering
@@ -65,13 +65,25 @@ struct Circle : Shape {
     Circle(float radius) : Shape(radius) {}
 };
 
-struct Seek {};
+struct SteeringForce {
+    SteeringForce() = default;
+
+    glm::vec2 force{ glm::vec2(0.0f) }; // accumulated steering force of the tick
+    float rest{ 0.0f }; // speed below which the entity holds its position
+    uint32_t period{ 1 }; // ticks between steering updates, see lod::Schedule
+    bool held{ false }; // force kept for a settled agent, see lod::Schedule
+};
+
+struct Seek {
+    float weight{ 1.0f };
+};
 
 struct Flee {
     Flee() = default;
     Flee(float radius) : radius(radius) {}
 
     float radius{ 100.0f };
+    float weight{ 1.0f };
 };
 
 struct Arrive {
@@ -79,6 +91,8 @@ struct Arrive {
     Arrive(float dec) : deceleration(dec) {}
 
     float deceleration{ 2.0f };
+    float weight{ 1.0f };
+    float despawn{ 0.0f };  // distance to the target to remove the agent at, if positive
 };
 
 struct Pursuit {
@@ -86,6 +100,7 @@ struct Pursuit {
     Pursuit(ecs::Entity::Id evaderId) : evaderId(evaderId) {}
 
     ecs::Entity::Id evaderId{ static_cast<ecs::Entity::Id>(-1) };
+    float weight{ 1.0f };
 };
 
 struct Evade {
@@ -96,6 +111,50 @@ struct Evade {
 
     ecs::Entity::Id pursuerId{ static_cast<ecs::Entity::Id>(-1) };
     float radius{ 100.0f };
+    float weight{ 1.0f };
+};
+
+struct Separation {
+    Separation() = default;
+    Separation(float radius) : radius(radius) {}
+
+    float radius{ 30.0f };
+    float weight{ 1.0f };
+};
+
+struct Alignment {
+    Alignment() = default;
+    Alignment(float radius) : radius(radius) {}
+
+    float radius{ 50.0f };
+    float weight{ 1.0f };
+};
+
+struct Cohesion {
+    Cohesion() = default;
+    Cohesion(float radius) : radius(radius) {}
+
+    float radius{ 50.0f };
+    float weight{ 1.0f };
+};
+
+struct ObstacleAvoidance {
+    ObstacleAvoidance() = default;
+    ObstacleAvoidance(float radius, float length)
+        : radius(radius),
+          length(length) {}
+
+    float radius{ 15.0f };  // of the agent
+    float length{ 50.0f };  // of the detection box at rest, twice that at max speed
+    float weight{ 1.0f };
+};
+
+struct WallAvoidance {
+    WallAvoidance() = default;
+    WallAvoidance(float feeler) : feeler(feeler) {}
+
+    float feeler{ 40.0f };  // length of the front feeler, the side ones are half as long
+    float weight{ 1.0f };
 };
 
 struct Wander {
@@ -113,7 +172,56 @@ struct Wander {
     float radius{ 25.0f };
     float distance{ 100.0f };
     float jitter{ 5.0f };
+    float weight{ 1.0f };
+
+    // Random stream: its key mixes the seed with the entity ID, and the
+    // counter advances every tick
+    uint32_t seed{ 0 };
+    uint32_t counter{ 0 };
+};
+
+struct Global {
+    Global() = default;
+    Global(uint64_t handle) : handle(handle) {}
+
+    uint64_t handle{ static_cast<uint64_t>(-1) };  // unique among the shards, see shard::Shard
+};
+
+struct Ghost {
+    Ghost() = default;
+    Ghost(uint32_t owner, uint64_t exchange)
+        : owner(owner),
+          exchange(exchange) {}
+
+    uint32_t owner{ 0 };     // shard simulating the agent
+    uint64_t exchange{ 0 };  // last exchange that refreshed it
 };
 
 }  // component
 }  // steering
+
+// Compile-time component IDs, so that the masks of views and prefabs over
+// these types are constants
+static_assert(20 <= ecs::Component::STATIC_COMPONENTS,
+              "The steering components need 20 static IDs: build with "
+              "-DECS_STATIC_COMPONENTS=20 or more, or a wider ECS_MAX_COMPONENTS");
+ECS_COMPONENT_ID(steering::component::Transform,          0)
+ECS_COMPONENT_ID(steering::component::Move,               1)
+ECS_COMPONENT_ID(steering::component::SteeringForce,      2)
+ECS_COMPONENT_ID(steering::component::Color,              3)
+ECS_COMPONENT_ID(steering::component::Triangle,           4)
+ECS_COMPONENT_ID(steering::component::Crosshair,          5)
+ECS_COMPONENT_ID(steering::component::Circle,             6)
+ECS_COMPONENT_ID(steering::component::Seek,               7)
+ECS_COMPONENT_ID(steering::component::Flee,               8)
+ECS_COMPONENT_ID(steering::component::Arrive,             9)
+ECS_COMPONENT_ID(steering::component::Pursuit,           10)
+ECS_COMPONENT_ID(steering::component::Evade,             11)
+ECS_COMPONENT_ID(steering::component::Wander,            12)
+ECS_COMPONENT_ID(steering::component::Separation,        13)
+ECS_COMPONENT_ID(steering::component::Alignment,         14)
+ECS_COMPONENT_ID(steering::component::Cohesion,          15)
+ECS_COMPONENT_ID(steering::component::ObstacleAvoidance, 16)
+ECS_COMPONENT_ID(steering::component::WallAvoidance,     17)
+ECS_COMPONENT_ID(steering::component::Global,            18)
+ECS_COMPONENT_ID(steering::component::Ghost,             19)
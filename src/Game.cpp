@@ -4,11 +4,7 @@
 
 #include <SDL.h>
 #include <glm/glm.hpp>
-#include <glm/gtc/constants.hpp>
 
-#include <ECS.h>
-
-#include "Component.h"
 #include "System.h"
 
 namespace steering {
@@ -38,93 +34,7 @@ bool Game::Init() {
         return false;
     }
 
-    auto target = scene_.NewEntity();
-    auto circle = scene_.NewEntity();
-    scene_.AddComponent<component::Circle>(
-        target,
-        5.0f    // radius
-    );
-    scene_.AddComponent<component::Circle>(
-        circle,
-        25.0f   // radius (could be changed)
-    );
-    scene_.AddComponent<component::Transform>(
-        target,
-        glm::vec2(0.0f, 0.0f),
-        glm::vec2(0.0f, -1.0f),
-        glm::vec2(1.0f, 1.0f)
-    );
-    scene_.AddComponent<component::Transform>(
-        circle,
-        glm::vec2(0.0f, 0.0f),
-        glm::vec2(0.0f, -1.0f),
-        glm::vec2(1.0f, 1.0f)
-    );
-    scene_.AddComponent<component::Color>(target, 255, 0, 0, 255);
-    scene_.AddComponent<component::Color>(circle, 0, 255, 0, 255);
-
-    auto wander = scene_.NewEntity();
-    auto agent = scene_.NewEntity();
-    scene_.AddComponent<component::Wander>(
-        wander,
-        target,
-        circle,
-         25.0f, // radius
-         35.0f, // distance
-        350.0f  // jitter
-    );
-    scene_.AddComponent<component::Triangle>(
-        wander,
-        10.0f // radius
-    );
-    scene_.AddComponent<component::Transform>(
-        wander,
-        glm::vec2(380.0f, 380.0f), // position
-        glm::vec2(0.0f, -1.0f),    // rotation (head)
-        glm::vec2(0.75f, 1.0f)     // scale
-    );
-    scene_.AddComponent<component::Move>(
-        wander,
-        glm::vec2(0.0f, 0.0f), // velocity
-          1.0f, // mass
-        200.0f, // max speed
-        100.0f  // max force
-    );
-    scene_.AddComponent<component::Color>(wander, 0, 0, 255, 255);
-
-    scene_.AddComponent<component::Pursuit>(agent, wander);
-    scene_.AddComponent<component::Triangle>(
-        agent,
-        15.0f // radius
-    );
-    scene_.AddComponent<component::Transform>(
-        agent,
-        glm::vec2(125.0f, 125.0f), // position
-        glm::vec2(0.0f, -1.0f),    // rotation (head)
-        glm::vec2(0.75f, 1.0f)     // scale
-    );
-    scene_.AddComponent<component::Move>(
-        agent,
-        glm::vec2(0.0f, 0.0f), // velocity
-          1.0f, // mass
-        150.0f, // max speed
-         85.0f  // max force
-    );
-    scene_.AddComponent<component::Color>(agent, 255, 0, 0, 255);
-
-    auto crosshair = scene_.NewEntity();
-    scene_.AddComponent<component::Crosshair>(
-        crosshair,
-        5.0f
-    );
-    scene_.AddComponent<component::Transform>(
-        crosshair,
-        glm::vec2(250.0f, 250.0f),
-        glm::vec2(0.0f, -1.0f),
-        glm::vec2(1.0f, 1.0f)
-    );
-    scene_.AddComponent<component::Color>(crosshair, 0, 0, 0, 255);
-
+    simulation_.Init();
     return true;
 }
 
@@ -139,12 +49,16 @@ void Game::Shutdown() {
 }
 
 void Game::Mainloop() {
-    ticks_   = SDL_GetTicks();
+    counter_ = SDL_GetPerformanceCounter();
     running_ = true;
     while (running_) {
-        ProcessInput();
-        Update();
-        Draw();
+        {
+            Profiler::Scope scope(&simulation_.GetProfiler(), "Game::Frame");
+            ProcessInput();
+            Update();
+            Draw();
+        }
+        Profile();
     }
 }
 
@@ -155,8 +69,18 @@ void Game::ProcessInput() {
             case SDL_QUIT:
                 running_ = false;
                 break;
+            case SDL_KEYDOWN:
+                if (event.key.keysym.scancode == SDL_SCANCODE_P && !event.key.repeat) {
+                    profile_ = !profile_;
+                }
+                break;
             case SDL_MOUSEBUTTONDOWN:
                 SDL_GetMouseState(&mouse_.x, &mouse_.y);
+                simulation_.SetTarget(camera_.ToWorld(glm::vec2(mouse_.x, mouse_.y)));
+                break;
+            case SDL_MOUSEWHEEL:
+                SDL_GetMouseState(&mouse_.x, &mouse_.y);
+                camera_.ZoomAt(glm::vec2(mouse_.x, mouse_.y), event.wheel.y < 0 ? 0.8f : 1.25f);
                 break;
         }
     }
@@ -165,40 +89,62 @@ void Game::ProcessInput() {
     if (state[SDL_SCANCODE_ESCAPE]) {
         running_ = false;
     }
+
+    // Pan a fixed number of pixels per frame, whatever the zoom
+    auto pan = glm::vec2(0.0f);
+    pan.x += state[SDL_SCANCODE_RIGHT] ? 1.0f : 0.0f;
+    pan.x -= state[SDL_SCANCODE_LEFT] ? 1.0f : 0.0f;
+    pan.y += state[SDL_SCANCODE_DOWN] ? 1.0f : 0.0f;
+    pan.y -= state[SDL_SCANCODE_UP] ? 1.0f : 0.0f;
+    camera_.center += pan * 10.0f / camera_.zoom;
 }
 
 void Game::Update() {
-    while (!SDL_TICKS_PASSED(SDL_GetTicks(), ticks_ + 16));
-
-    float dt = (SDL_GetTicks() - ticks_) / 1000.0f;
-    if (profile_) {
-        SDL_Log("FPS: %f", 1.0f / dt);
+    auto counter = SDL_GetPerformanceCounter();
+    auto dt = static_cast<float>(counter - counter_) / SDL_GetPerformanceFrequency();
+    counter_ = counter;
+
+    // Don't try to catch up after a stall, e.g. while the window is dragged
+    accumulator_ += glm::min(dt, 0.25f);
+    while (FIXED_DT <= accumulator_) {
+        simulation_.Step(FIXED_DT);
+        accumulator_ -= FIXED_DT;
     }
-    dt = glm::clamp<float>(dt, 0.0f, 0.05f);
-
-
-    update::Crosshair(glm::vec2(mouse_.x, mouse_.y), scene_);
-    update::Wraparound(SCREEN_W, SCREEN_H, scene_);
-
-    behavior::Seek(glm::vec2(mouse_.x, mouse_.y), scene_, dt);
-    behavior::Flee(glm::vec2(mouse_.x, mouse_.y), scene_, dt);
-    behavior::Arrive(glm::vec2(mouse_.x, mouse_.y), scene_, dt);
-    behavior::Pursuit(scene_, dt);
-    behavior::Evade(scene_, dt);
-    behavior::Wander(scene_, dt);
-
-    ticks_ = SDL_GetTicks();
 }
 
 void Game::Draw() {
+    Profiler::Scope scope(&simulation_.GetProfiler(), "Game::Draw");
     SDL_SetRenderDrawColor(renderer_, 255, 255, 255, SDL_ALPHA_OPAQUE);
     SDL_RenderClear(renderer_);
 
-    draw::Crosshair(renderer_, scene_);
-    draw::Triangle(renderer_, scene_);
-    draw::Circle(renderer_, scene_);
+    // How far the frame is between the last two steps
+    auto alpha = accumulator_ / FIXED_DT;
+    auto &scene = simulation_.GetScene();
+    draw::Obstacles(batch_, camera_, simulation_.GetObstacles(), component::Color(160, 160, 160, 255));
+    draw::Crosshair(batch_, camera_, scene, alpha);
+    draw::Triangle(batch_, camera_, simulation_.GetGrid(), scene, alpha);
+    draw::Circle(batch_, camera_, scene, alpha);
+    batch_.Submit(renderer_);
 
     SDL_RenderPresent(renderer_);
 }
 
+void Game::Profile() {
+    auto &profiler = simulation_.GetProfiler();
+    profiler.EndFrame();
+
+    // Report the per-frame times of the last frames once per second
+    auto now = SDL_GetPerformanceCounter();
+    if (!profile_ || now - report_ < SDL_GetPerformanceFrequency()) {
+        return;
+    }
+    report_ = now;
+    for (auto &name : profiler.GetNames()) {
+        SDL_Log("%-28s p50 %7.3f ms  p95 %7.3f ms  max %7.3f ms", name.c_str(),
+                profiler.Percentile(name, 50.0),
+                profiler.Percentile(name, 95.0),
+                profiler.Percentile(name, 100.0));
+    }
+}
+
 }  // steering steering
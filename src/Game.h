@@ -9,11 +9,17 @@
 
 #include <ECS.h>
 
-namespace steering {
+#include "Camera.h"
+#include "Render.h"
+#include "Simulation.h"
 
-constexpr unsigned int SCREEN_W(1440);
-constexpr unsigned int SCREEN_H(1440);
+namespace steering {
 
+/**
+ * Game runs a Simulation in a window. The simulation advances in fixed steps
+ * of FIXED_DT, as many as the elapsed time allows, and the frames are drawn
+ * in between two steps by interpolating the agents' transforms.
+ */
 class Game {
 public:
     Game() {};
@@ -24,17 +30,23 @@ public:
     void ProcessInput();
     void Update();
     void Draw();
+    void Profile();
 
 private:
     SDL_Window     *window_{ nullptr };
     SDL_Renderer *renderer_{ nullptr };
 
-    ecs::Scene scene_;
+    Simulation simulation_{};
+    render::Batch batch_{};
+    // Panned with the arrow keys and zoomed with the mouse wheel
+    render::Camera camera_{ glm::vec2(SCREEN_W, SCREEN_H) * 0.5f, glm::vec2(SCREEN_W, SCREEN_H) };
 
-    uint32_t ticks_{ 0 };
+    uint64_t       counter_{ 0 };
+    float      accumulator_{ 0.0f };
     bool   running_{ false };
     bool  updating_{ false };
-    bool   profile_{ true };
+    bool   profile_{ false };  // toggled with P
+    uint64_t report_{ 0 };
 
     struct MouseState {
         int x{ SCREEN_W / 2 };
@@ -0,0 +1,293 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include <ECS.h>
+
+#include "Component.h"
+
+namespace steering {
+namespace integrator {
+/**
+ * Apply a steering force to an agent for one time step.
+ * The force is limited to the agent's max force and the resulting velocity
+ * to its max speed. The position and heading are updated only when the agent
+ * moves at least at the rest speed.
+ */
+inline void Integrate(component::Transform &t, component::Move &m,
+                      glm::vec2 steering, float dt,
+                      float rest = glm::epsilon<float>()) {
+    // Limit the steering force to the maximum allowed force.
+    // This help to create smooth movement, preventing the entity from
+    // instantly turning around to face the target.
+    auto lenS = glm::length(steering);
+    if (m.maxForce < lenS) {
+        steering /= lenS;
+        steering *= m.maxForce;
+    }
+
+    // Calculate acceleration based on the steering force.
+    auto acc = steering / m.mass;
+    m.velocity += acc * dt;
+
+    // Limit the entity's speed to its maxmum speed.
+    auto lenV1 = glm::length(m.velocity);
+    if (m.maxSpeed < lenV1) {
+        m.velocity /= lenV1;
+        m.velocity *= m.maxSpeed;
+    }
+
+    // If the entity is (almost) stationary, keep its position and heading.
+    auto lenV2 = glm::length(m.velocity);
+    if (lenV2 < rest || lenV2 < glm::epsilon<float>()) {
+        return;
+    }
+    t.position += m.velocity * dt;
+    t.rotation = m.velocity / lenV2;
+}
+
+/**
+ * Add a weighted steering force to an agent's accumulator. The running sum is
+ * truncated to the agent's max force, so forces added first take priority.
+ * Returns false if the budget was already used up.
+ */
+inline bool Accumulate(component::SteeringForce &sf, glm::vec2 force,
+                       float weight, float maxForce) {
+    auto remaining = maxForce - glm::length(sf.force);
+    if (remaining <= 0.0f) {
+        return false;
+    }
+    force *= weight;
+    auto len = glm::length(force);
+    if (len < remaining) {
+        sf.force += force;
+    } else {
+        sf.force += force / len * remaining;
+    }
+    return true;
+}
+
+/**
+ * Batch holds packed arrays of agent state for IntegrateBatch.
+ * Position, heading and velocity are updated in place.
+ */
+struct Batch {
+    float *px{ nullptr }, *py{ nullptr };  // position
+    float *hx{ nullptr }, *hy{ nullptr };  // heading (rotation)
+    float *vx{ nullptr }, *vy{ nullptr };  // velocity
+    const float *fx{ nullptr }, *fy{ nullptr };  // steering force
+    const float *mass{ nullptr };
+    const float *maxSpeed{ nullptr };
+    const float *maxForce{ nullptr };
+    const float *rest{ nullptr };  // rest speed
+    size_t size{ 0 };
+};
+
+namespace simd {
+#if defined(__AVX2__)
+constexpr size_t WIDTH = 8;
+typedef __m256 Float;
+typedef __m256 Mask;
+inline Float Load(const float *p) { return _mm256_loadu_ps(p); }
+inline void Store(float *p, Float a) { _mm256_storeu_ps(p, a); }
+inline Float Set(float a) { return _mm256_set1_ps(a); }
+inline Float Add(Float a, Float b) { return _mm256_add_ps(a, b); }
+inline Float Sub(Float a, Float b) { return _mm256_sub_ps(a, b); }
+inline Float Mul(Float a, Float b) { return _mm256_mul_ps(a, b); }
+inline Float Div(Float a, Float b) { return _mm256_div_ps(a, b); }
+inline Float RsqrtEstimate(Float a) { return _mm256_rsqrt_ps(a); }
+inline Mask Greater(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+inline Mask Or(Mask a, Mask b) { return _mm256_or_ps(a, b); }
+inline Float Select(Mask m, Float a, Float b) { return _mm256_blendv_ps(b, a, m); }
+#elif defined(__SSE2__) || defined(_M_X64)
+constexpr size_t WIDTH = 4;
+typedef __m128 Float;
+typedef __m128 Mask;
+inline Float Load(const float *p) { return _mm_loadu_ps(p); }
+inline void Store(float *p, Float a) { _mm_storeu_ps(p, a); }
+inline Float Set(float a) { return _mm_set1_ps(a); }
+inline Float Add(Float a, Float b) { return _mm_add_ps(a, b); }
+inline Float Sub(Float a, Float b) { return _mm_sub_ps(a, b); }
+inline Float Mul(Float a, Float b) { return _mm_mul_ps(a, b); }
+inline Float Div(Float a, Float b) { return _mm_div_ps(a, b); }
+inline Float RsqrtEstimate(Float a) { return _mm_rsqrt_ps(a); }
+inline Mask Greater(Float a, Float b) { return _mm_cmpgt_ps(a, b); }
+inline Mask Or(Mask a, Mask b) { return _mm_or_ps(a, b); }
+inline Float Select(Mask m, Float a, Float b) {
+    return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+}
+#elif defined(__ARM_NEON)
+constexpr size_t WIDTH = 4;
+typedef float32x4_t Float;
+typedef uint32x4_t  Mask;
+inline Float Load(const float *p) { return vld1q_f32(p); }
+inline void Store(float *p, Float a) { vst1q_f32(p, a); }
+inline Float Set(float a) { return vdupq_n_f32(a); }
+inline Float Add(Float a, Float b) { return vaddq_f32(a, b); }
+inline Float Sub(Float a, Float b) { return vsubq_f32(a, b); }
+inline Float Mul(Float a, Float b) { return vmulq_f32(a, b); }
+inline Float Div(Float a, Float b) {
+    auto r = vrecpeq_f32(b);
+    r = vmulq_f32(r, vrecpsq_f32(b, r));
+    r = vmulq_f32(r, vrecpsq_f32(b, r));
+    return vmulq_f32(a, r);
+}
+inline Float RsqrtEstimate(Float a) {
+    auto r = vrsqrteq_f32(a);
+    return vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(a, r), r));
+}
+inline Mask Greater(Float a, Float b) { return vcgtq_f32(a, b); }
+inline Mask Or(Mask a, Mask b) { return vorrq_u32(a, b); }
+inline Float Select(Mask m, Float a, Float b) { return vbslq_f32(m, a, b); }
+#else
+constexpr size_t WIDTH = 1;
+#endif
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64) || defined(__ARM_NEON)
+/**
+ * Reciprocal square root from the hardware estimate refined by one
+ * Newton-Raphson step, which is accurate to about 22 bits.
+ */
+inline Float Rsqrt(Float a) {
+    auto r = RsqrtEstimate(a);
+    auto half = Mul(Set(0.5f), a);
+    auto step = Sub(Set(1.5f), Mul(half, Mul(r, r)));
+    return Mul(r, step);
+}
+
+/**
+ * Integrate WIDTH agents starting at the specified index.
+ */
+inline void IntegrateLanes(const Batch &b, size_t i, Float dt) {
+    auto one = Set(1.0f);
+
+    // Limit the steering force to the maximum allowed force.
+    auto fx = Load(b.fx + i);
+    auto fy = Load(b.fy + i);
+    auto maxF = Load(b.maxForce + i);
+    auto lenS2 = Add(Mul(fx, fx), Mul(fy, fy));
+    auto scaleS = Select(Greater(lenS2, Mul(maxF, maxF)), Mul(maxF, Rsqrt(lenS2)), one);
+
+    // Calculate acceleration and limit the speed to the maximum speed.
+    auto k = Div(Mul(scaleS, dt), Load(b.mass + i));
+    auto vx = Add(Load(b.vx + i), Mul(fx, k));
+    auto vy = Add(Load(b.vy + i), Mul(fy, k));
+    auto maxV = Load(b.maxSpeed + i);
+    auto lenV2 = Add(Mul(vx, vx), Mul(vy, vy));
+    auto fast = Greater(lenV2, Mul(maxV, maxV));
+    auto scaleV = Select(fast, Mul(maxV, Rsqrt(lenV2)), one);
+    vx = Mul(vx, scaleV);
+    vy = Mul(vy, scaleV);
+    Store(b.vx + i, vx);
+    Store(b.vy + i, vy);
+
+    // Move and reorient the agents that aren't at rest.
+    lenV2 = Select(fast, Mul(maxV, maxV), lenV2);
+    auto rest = Load(b.rest + i);
+    auto eps = Set(glm::epsilon<float>());
+    auto stop = Or(Greater(Mul(rest, rest), lenV2), Greater(Mul(eps, eps), lenV2));
+    auto inv = Rsqrt(lenV2);
+    Store(b.px + i, Select(stop, Load(b.px + i), Add(Load(b.px + i), Mul(vx, dt))));
+    Store(b.py + i, Select(stop, Load(b.py + i), Add(Load(b.py + i), Mul(vy, dt))));
+    Store(b.hx + i, Select(stop, Load(b.hx + i), Mul(vx, inv)));
+    Store(b.hy + i, Select(stop, Load(b.hy + i), Mul(vy, inv)));
+}
+#endif
+}  // simd
+
+/**
+ * Integrate a batch of agents. The agents are processed in SIMD lanes when
+ * the target supports SSE2, AVX2 or NEON, with the remainder handled by the
+ * scalar path. Lengths in the lanes use a refined reciprocal square root, so
+ * results may differ from Integrate in the last bits.
+ */
+inline void IntegrateBatch(const Batch &b, float dt) {
+    size_t i = 0;
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64) || defined(__ARM_NEON)
+    auto dtv = simd::Set(dt);
+    for (; i + simd::WIDTH <= b.size; i += simd::WIDTH) {
+        simd::IntegrateLanes(b, i, dtv);
+    }
+#endif
+    for (; i < b.size; i++) {
+        component::Transform t(glm::vec2(b.px[i], b.py[i]), glm::vec2(b.hx[i], b.hy[i]), glm::vec2(1.0f));
+        component::Move m(glm::vec2(b.vx[i], b.vy[i]), b.mass[i], b.maxSpeed[i], b.maxForce[i]);
+        Integrate(t, m, glm::vec2(b.fx[i], b.fy[i]), dt, b.rest[i]);
+        b.px[i] = t.position.x; b.py[i] = t.position.y;
+        b.hx[i] = t.rotation.x; b.hy[i] = t.rotation.y;
+        b.vx[i] = m.velocity.x; b.vy[i] = m.velocity.y;
+    }
+}
+
+/**
+ * Integrate packed rows of Transform, Move and SteeringForce components, e.g.
+ * a chunk of an ecs::ChunkView. The rows are transposed into packed arrays in
+ * blocks of ecs::CHUNK_SIZE, integrated with IntegrateBatch and written back.
+ * Given the change ticks of the Transform rows, the rows whose position
+ * changed are set to the tick, and likewise the Move rows whose velocity
+ * changed given theirs.
+ */
+inline void IntegrateRows(component::Transform *t, component::Move *m,
+                          const component::SteeringForce *sf,
+                          size_t size, float dt,
+                          uint32_t *ticks = nullptr, uint32_t tick = 0,
+                          uint32_t *moveTicks = nullptr) {
+    constexpr size_t N = ecs::CHUNK_SIZE;
+    alignas(64) float px[N], py[N], hx[N], hy[N], vx[N], vy[N];
+    alignas(64) float fx[N], fy[N], mass[N], maxSpeed[N], maxForce[N], rs[N];
+
+    for (size_t first = 0; first < size; first += N) {
+        auto n = std::min(N, size - first);
+        for (size_t i = 0; i < n; i++) {
+            const auto &ti = t[first + i];
+            const auto &mi = m[first + i];
+            hx[i] = ti.rotation.x; hy[i] = ti.rotation.y;
+            vx[i] = mi.velocity.x; vy[i] = mi.velocity.y;
+            const auto &si = sf[first + i];
+            px[i] = ti.position.x; py[i] = ti.position.y;
+            fx[i] = si.force.x; fy[i] = si.force.y;
+            mass[i] = mi.mass; maxSpeed[i] = mi.maxSpeed; maxForce[i] = mi.maxForce;
+            rs[i] = si.rest;
+        }
+
+        Batch batch;
+        batch.px = px; batch.py = py;
+        batch.hx = hx; batch.hy = hy;
+        batch.vx = vx; batch.vy = vy;
+        batch.fx = fx; batch.fy = fy;
+        batch.mass = mass; batch.maxSpeed = maxSpeed; batch.maxForce = maxForce;
+        batch.rest = rs;
+        batch.size = n;
+        IntegrateBatch(batch, dt);
+
+        for (size_t i = 0; i < n; i++) {
+            auto &ti = t[first + i];
+            auto &mi = m[first + i];
+            if (ticks != nullptr && (ti.position.x != px[i] || ti.position.y != py[i])) {
+                ticks[first + i] = tick;
+            }
+            if (moveTicks != nullptr && (mi.velocity.x != vx[i] || mi.velocity.y != vy[i])) {
+                moveTicks[first + i] = tick;
+            }
+            ti.position = glm::vec2(px[i], py[i]);
+            ti.rotation = glm::vec2(hx[i], hy[i]);
+            mi.velocity = glm::vec2(vx[i], vy[i]);
+        }
+    }
+}
+
+}  // integrator
+}  // steering
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+#include <glm/glm.hpp>
+
+#include <ECS.h>
+
+#include "Component.h"
+#include "Parallel.h"
+
+namespace steering {
+namespace lod {
+/**
+ * Config maps the metric of an agent, e.g. its distance to the camera, to
+ * the number of ticks between its steering updates: agents below near
+ * update every tick, and every doubling of the metric halves the rate, up
+ * to 2^(levels - 1) ticks. With one level every agent updates every tick.
+ */
+struct Config {
+    float      near{ 400.0f };
+    uint32_t levels{ 1 };
+};
+
+/**
+ * Get the update period of an agent from its metric.
+ */
+inline uint32_t Period(const Config &config, float metric) {
+    auto longest = 1u << (std::min<uint32_t>(std::max<uint32_t>(config.levels, 1), 32) - 1);
+    uint32_t period = 1;
+    for (auto bound = config.near; period < longest && bound <= metric; bound *= 2.0f) {
+        period *= 2;
+    }
+    return period;
+}
+
+/**
+ * Check if the steering of an agent is updated at a tick. The agents of a
+ * period are spread over its ticks round robin by their entity index, so
+ * that every tick updates about the same share of them.
+ */
+inline bool IsDue(uint64_t tick, ecs::Entity::Id id, uint32_t period) {
+    return (tick + ecs::Entity::GetIndex(id)) % period == 0;
+}
+
+/**
+ * Select the agents whose steering is updated at the current tick. A due
+ * agent gets a period from the metric of its Transform, its accumulator
+ * is cleared and its SteeringForce is marked as changed. The other agents
+ * keep the force of their last update, which update::Integrate applies
+ * every tick, and are skipped by the behaviors iterating the Due view.
+ *
+ * A due agent for which hold(id) is true is settled: nothing its behaviors
+ * read changed since its last update, so they would compute the same force
+ * again. The first time, it is updated and its force is marked as held, so
+ * that update::Integrate keeps it. From then on, it keeps its force and
+ * rest speed and is skipped like the agents that aren't due, until hold
+ * returns false.
+ *
+ * The SteeringForce changes must be tracked with Scene::TrackChanges, and
+ * the metric is called as metric(id, transform), concurrently given a pool,
+ * as is hold.
+ */
+template<class Metric, class Hold>
+void Schedule(const Config &config, Metric &&metric, Hold &&hold,
+              ecs::Scene &scene, ThreadPool *pool = nullptr) {
+    auto tick = scene.GetTick();
+    Each(pool, ecs::SceneView<component::Transform,
+                              component::SteeringForce>(scene), [&](
+            ecs::Entity::Id           id,
+            component::Transform     &t,
+            component::SteeringForce &sf) {
+        if (!IsDue(tick, id, sf.period)) {
+            return;
+        }
+        auto settled = hold(id);
+        if (settled && sf.held) {
+            return;
+        }
+        sf.force = glm::vec2(0.0f);
+        sf.rest = 0.0f;
+        sf.period = Period(config, metric(id, t));
+        sf.held = settled;
+        scene.MarkChanged<component::SteeringForce>(id);
+    });
+}
+
+/**
+ * Select the agents whose steering is updated at the current tick, none of
+ * them held.
+ */
+template<class Metric>
+void Schedule(const Config &config, Metric &&metric, ecs::Scene &scene, ThreadPool *pool = nullptr) {
+    Schedule(config, std::forward<Metric>(metric), [](ecs::Entity::Id) {
+        return false;
+    }, scene, pool);
+}
+
+/**
+ * Get the view of the agents having the component types, which must
+ * include SteeringForce, whose steering is updated at the current tick.
+ * Every agent is due when the SteeringForce changes aren't tracked.
+ */
+template<class... ComponentTypes>
+ecs::SceneView<ComponentTypes...> Due(ecs::Scene &scene) {
+    return ecs::SceneView<ComponentTypes...>(scene)
+        .template ChangedSince<component::SteeringForce>(scene.GetTick());
+}
+
+}  // lod
+}  // steering
@@ -0,0 +1,346 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include "Component.h"
+#include "Transformation.h"
+
+namespace steering {
+namespace spatial {
+/**
+ * Box is an axis-aligned bounding box.
+ */
+struct Box {
+    glm::vec2 min{ glm::vec2(0.0f) };
+    glm::vec2 max{ glm::vec2(0.0f) };
+
+    bool Overlaps(const Box &other) const {
+        return min.x <= other.max.x && other.min.x <= max.x &&
+               min.y <= other.max.y && other.min.y <= max.y;
+    }
+
+    Box Union(const Box &other) const {
+        return Box{ glm::min(min, other.min), glm::max(max, other.max) };
+    }
+
+    glm::vec2 Center() const {
+        return (min + max) * 0.5f;
+    }
+};
+
+/**
+ * Bvh is a static bounding volume hierarchy over boxes, built once, e.g. at
+ * level load, by splitting the boxes at the median of their centers along
+ * the longest axis. The nodes are stored depth first in one array, so a
+ * query walks memory mostly forward and never allocates.
+ */
+class Bvh {
+public:
+    // Boxes per leaf
+    static constexpr uint32_t LEAF_SIZE = 4;
+
+    Bvh() = default;
+
+    explicit Bvh(const std::vector<Box> &boxes) {
+        Build(boxes);
+    }
+
+    /**
+     * Build the hierarchy over the boxes, replacing the previous one.
+     */
+    void Build(const std::vector<Box> &boxes) {
+        boxes_ = boxes;
+        order_.resize(boxes.size());
+        for (uint32_t i = 0; i < order_.size(); i++) {
+            order_[i] = i;
+        }
+        nodes_.clear();
+        nodes_.reserve(boxes.empty() ? 0 : 2 * (boxes.size() / LEAF_SIZE + 1));
+        if (!boxes.empty()) {
+            Split(0, static_cast<uint32_t>(boxes.size()));
+        }
+    }
+
+    /**
+     * Visit the boxes overlapping a box. The function is called as
+     * func(index) with the index of the box in the built vector.
+     */
+    template<class Func>
+    void Query(const Box &box, Func &&func) const {
+        if (nodes_.empty()) {
+            return;
+        }
+        uint32_t stack[64];
+        uint32_t top = 0;
+        stack[top++] = 0;
+        while (top != 0) {
+            auto &node = nodes_[stack[--top]];
+            if (!node.box.Overlaps(box)) {
+                continue;
+            }
+            if (node.count != 0) {
+                for (auto i = node.first; i < node.first + node.count; i++) {
+                    if (boxes_[order_[i]].Overlaps(box)) {
+                        func(order_[i]);
+                    }
+                }
+            } else {
+                // The left child follows its parent
+                stack[top++] = node.first;
+                stack[top++] = static_cast<uint32_t>(&node - nodes_.data()) + 1;
+            }
+        }
+    }
+
+    /**
+     * Get the number of boxes.
+     */
+    size_t Size() const {
+        return boxes_.size();
+    }
+
+private:
+    /**
+     * Node of the hierarchy: a leaf holds count boxes of the order from
+     * first, an inner node (count 0) the index of its right child in first.
+     */
+    struct Node {
+        Box      box{};
+        uint32_t first{ 0 };
+        uint32_t count{ 0 };
+    };
+
+    uint32_t Split(uint32_t first, uint32_t last) {
+        auto index = static_cast<uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+        auto box = boxes_[order_[first]];
+        auto centers = Box{ box.Center(), box.Center() };
+        for (auto i = first + 1; i < last; i++) {
+            auto &b = boxes_[order_[i]];
+            box = box.Union(b);
+            centers = centers.Union(Box{ b.Center(), b.Center() });
+        }
+        nodes_[index].box = box;
+        if (last - first <= LEAF_SIZE) {
+            nodes_[index].first = first;
+            nodes_[index].count = last - first;
+            return index;
+        }
+
+        auto extent = centers.max - centers.min;
+        auto axis = extent.x < extent.y ? 1 : 0;
+        auto middle = first + (last - first) / 2;
+        std::nth_element(order_.begin() + first, order_.begin() + middle, order_.begin() + last,
+                         [&](uint32_t a, uint32_t b) {
+            return boxes_[a].Center()[axis] < boxes_[b].Center()[axis];
+        });
+        Split(first, middle);
+        auto right = Split(middle, last);
+        nodes_[index].first = right;
+        return index;
+    }
+
+    std::vector<Box>    boxes_{};
+    std::vector<uint32_t> order_{};  // box indices, grouped by leaf
+    std::vector<Node>     nodes_{};
+};
+
+/**
+ * Obstacle is a static circle the agents steer around.
+ */
+struct Obstacle {
+    glm::vec2 position{ glm::vec2(0.0f) };
+    float       radius{ 0.0f };
+};
+
+/**
+ * Wall is a static segment the agents steer away from, on either side.
+ */
+struct Wall {
+    Wall() = default;
+    Wall(glm::vec2 from, glm::vec2 to)
+        : from(from),
+          to(to) {
+        auto d = to - from;
+        auto length = glm::length(d);
+        if (glm::epsilon<float>() < length) {
+            normal = glm::vec2(-d.y, d.x) / length;
+        }
+    }
+
+    glm::vec2   from{ glm::vec2(0.0f) };
+    glm::vec2     to{ glm::vec2(0.0f) };
+    glm::vec2 normal{ glm::vec2(0.0f) };  // unit, to the left of from -> to
+};
+
+/**
+ * Obstacles holds the static obstacles and walls of a level, each in its
+ * own Bvh. Unlike the agents, they don't wrap around the world's edges.
+ */
+class Obstacles {
+public:
+    Obstacles() = default;
+
+    Obstacles(std::vector<Obstacle> obstacles, std::vector<Wall> walls)
+        : obstacles_(std::move(obstacles)),
+          walls_(std::move(walls)) {
+        std::vector<Box> boxes;
+        boxes.reserve(obstacles_.size());
+        for (auto &o : obstacles_) {
+            boxes.push_back(Box{ o.position - glm::vec2(o.radius), o.position + glm::vec2(o.radius) });
+        }
+        obstacleBvh_.Build(boxes);
+        boxes.clear();
+        for (auto &w : walls_) {
+            boxes.push_back(Box{ glm::min(w.from, w.to), glm::max(w.from, w.to) });
+        }
+        wallBvh_.Build(boxes);
+    }
+
+    /**
+     * Visit the obstacles whose bounds overlap a box, as
+     * func(const Obstacle &).
+     */
+    template<class Func>
+    void QueryObstacles(const Box &box, Func &&func) const {
+        obstacleBvh_.Query(box, [&](uint32_t i) { func(obstacles_[i]); });
+    }
+
+    /**
+     * Visit the walls whose bounds overlap a box, as func(const Wall &).
+     */
+    template<class Func>
+    void QueryWalls(const Box &box, Func &&func) const {
+        wallBvh_.Query(box, [&](uint32_t i) { func(walls_[i]); });
+    }
+
+    const std::vector<Obstacle> &GetObstacles() const {
+        return obstacles_;
+    }
+
+    const std::vector<Wall> &GetWalls() const {
+        return walls_;
+    }
+
+private:
+    std::vector<Obstacle> obstacles_{};
+    std::vector<Wall>         walls_{};
+    Bvh                 obstacleBvh_{};
+    Bvh                     wallBvh_{};
+};
+
+// Share of the max force an agent brakes with before an obstacle
+constexpr float BRAKING_WEIGHT(0.2f);
+
+/**
+ * Get the force steering an agent around the closest obstacle in the
+ * detection box ahead of it, whose length grows with the agent's speed: it
+ * pushes the agent sideways, the harder the closer and the more centered
+ * the obstacle, and brakes it. The box is found in the obstacle Bvh and the
+ * candidates are tested in the agent's local space.
+ */
+inline glm::vec2 AvoidObstacles(const Obstacles &obstacles,
+                                const component::Transform &t,
+                                const component::Move &m,
+                                const component::ObstacleAvoidance &oa) {
+    auto speed = glm::length(m.velocity);
+    auto length = oa.length * (1.0f + (glm::epsilon<float>() < m.maxSpeed ? speed / m.maxSpeed : 0.0f));
+    auto tip = ToWorld(glm::vec2(length, 0.0f), t.position, t.rotation, glm::vec2(1.0f));
+
+    // Local axes of the agent, as in ToWorld
+    auto r = Rotation(t.rotation);
+    auto forward = glm::vec2(r.x, -r.y);
+    auto side = glm::vec2(r.y, r.x);
+
+    auto closest = length;
+    auto found = false;
+    glm::vec2 local(0.0f);
+    float expanded = 0.0f;
+    Box box{ glm::min(t.position, tip) - glm::vec2(oa.radius), glm::max(t.position, tip) + glm::vec2(oa.radius) };
+    obstacles.QueryObstacles(box, [&](const Obstacle &o) {
+        auto d = o.position - t.position;
+        auto x = glm::dot(d, forward);
+        auto y = glm::dot(d, side);
+        auto e = o.radius + oa.radius;
+        if (x < 0.0f || length < x - o.radius || e <= glm::abs(y)) {
+            return;
+        }
+        // Nearest intersection of the agent's path with the expanded circle
+        auto root = glm::sqrt(e * e - y * y);
+        auto hit = x - root <= 0.0f ? x + root : x - root;
+        if (!found || hit < closest) {
+            found = true;
+            closest = hit;
+            local = glm::vec2(x, y);
+            expanded = e;
+        }
+    });
+    if (!found) {
+        return glm::vec2(0.0f);
+    }
+
+    auto multiplier = 1.0f + (length - local.x) / length;
+    auto lateral = (local.y < 0.0f ? 1.0f : -1.0f) * (1.0f - glm::abs(local.y) / expanded) * multiplier;
+    auto braking = -glm::max(0.0f, 1.0f - local.x / length) * BRAKING_WEIGHT;
+    return ToWorld(glm::vec2(braking, lateral) * m.maxForce, glm::vec2(0.0f), t.rotation, glm::vec2(1.0f));
+}
+
+/**
+ * Get the force steering an agent away from the walls crossed by its
+ * feelers: one ahead and two at 45 degrees, half as long. Every feeler
+ * pushes along the normal of the first wall it crosses, towards the agent's
+ * side, in proportion to how far it reaches past the wall. The feelers are
+ * moved to the world with ToWorld and share one query of the wall Bvh.
+ */
+inline glm::vec2 AvoidWalls(const Obstacles &obstacles,
+                            const component::Transform &t,
+                            const component::Move &m,
+                            const component::WallAvoidance &wa) {
+    constexpr size_t FEELERS = 3;
+    auto half = wa.feeler * 0.5f * glm::one_over_root_two<float>();
+    const glm::vec2 local[FEELERS] = {
+        glm::vec2(wa.feeler, 0.0f), glm::vec2(half, half), glm::vec2(half, -half)
+    };
+    glm::vec2 tips[FEELERS];
+    Box box{ t.position, t.position };
+    for (size_t i = 0; i < FEELERS; i++) {
+        tips[i] = ToWorld(local[i], t.position, t.rotation, glm::vec2(1.0f));
+        box = box.Union(Box{ tips[i], tips[i] });
+    }
+
+    float nearest[FEELERS] = { 1.0f, 1.0f, 1.0f };  // fraction of the feeler to the wall
+    glm::vec2 normals[FEELERS] = { glm::vec2(0.0f), glm::vec2(0.0f), glm::vec2(0.0f) };
+    obstacles.QueryWalls(box, [&](const Wall &w) {
+        auto s = w.to - w.from;
+        auto q = w.from - t.position;
+        auto facing = glm::dot(t.position - w.from, w.normal) < 0.0f ? -w.normal : w.normal;
+        for (size_t i = 0; i < FEELERS; i++) {
+            auto f = tips[i] - t.position;
+            auto denom = f.x * s.y - f.y * s.x;
+            if (glm::abs(denom) < glm::epsilon<float>()) {
+                continue;
+            }
+            auto along = (q.x * s.y - q.y * s.x) / denom;  // on the feeler
+            auto on = (q.x * f.y - q.y * f.x) / denom;     // on the wall
+            if (0.0f <= along && along < nearest[i] && 0.0f <= on && on <= 1.0f) {
+                nearest[i] = along;
+                normals[i] = facing;
+            }
+        }
+    });
+
+    auto force = glm::vec2(0.0f);
+    for (size_t i = 0; i < FEELERS; i++) {
+        force += normals[i] * (1.0f - nearest[i]);
+    }
+    return force * m.maxForce;
+}
+
+}  // spatial
+}  // steering
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+#include <ECS.h>
+
+#include "ThreadPool.h"
+
+namespace steering {
+
+// Rows of a view processed by one task. A multiple of 64 rows, so that the
+// ranges written by different tasks start on their own cache lines.
+constexpr uint64_t PARALLEL_GRAIN(1024);
+
+/**
+ * Split a range into tasks of a fixed grain and wait until all of them are
+ * done. The calling thread runs the first task and helps with the others.
+ * The split doesn't depend on the number of workers, so the work each task
+ * does is the same under any thread count.
+ */
+template<class Func>
+void ParallelFor(ThreadPool &pool, uint64_t size, uint64_t grain, Func &&func) {
+    if (size <= grain || pool.Size() == 0) {
+        func(0, size);
+        return;
+    }
+    auto tasks = (size + grain - 1) / grain;
+    std::atomic<uint64_t> done{ 0 };
+    for (uint64_t t = 1; t < tasks; t++) {
+        pool.Submit([&, t]() {
+            func(t * grain, std::min(size, (t + 1) * grain));
+            done++;
+        });
+    }
+    func(0, grain);
+    done++;
+    pool.Wait([&]() { return done == tasks; });
+}
+
+/**
+ * Invoke a function for every matching entity of a view, like
+ * SceneView::Each, on the thread pool. The function is called concurrently
+ * and must only write the components of the entity it's given; it can read
+ * other entities from the front buffers, with Scene::GetFrontComponent.
+ */
+template<class... ComponentTypes, class Func>
+void ParallelEach(ThreadPool &pool, const ecs::SceneView<ComponentTypes...> &view,
+                  Func &&func, uint64_t grain = PARALLEL_GRAIN) {
+    ParallelFor(pool, view.Size(), grain, [&](uint64_t first, uint64_t last) {
+        view.Each(first, last, func);
+    });
+}
+
+/**
+ * Invoke a function for every chunk of a ChunkView on the thread pool.
+ * Chunks start at multiples of ecs::CHUNK_SIZE rows, so the columns written
+ * by different tasks don't share cache lines.
+ */
+template<class... ComponentTypes, class Func>
+void ParallelChunks(ThreadPool &pool, const ecs::ChunkView<ComponentTypes...> &view,
+                    Func &&func, uint64_t grain = PARALLEL_GRAIN) {
+    static_assert(ecs::CHUNK_SIZE % 64 == 0);
+    auto chunks = (view.Size() + ecs::CHUNK_SIZE - 1) / ecs::CHUNK_SIZE;
+    auto grainChunks = std::max<uint64_t>(1, grain / ecs::CHUNK_SIZE);
+    ParallelFor(pool, chunks, grainChunks, [&](uint64_t first, uint64_t last) {
+        for (auto c = first; c < last; c++) {
+            func(view.At(c * ecs::CHUNK_SIZE));
+        }
+    });
+}
+
+/**
+ * Commit the first bytes of an arena from the thread pool, e.g. before the
+ * first run, so that on a NUMA system its pages are spread over the nodes
+ * of the workers instead of all being placed on the calling thread's. Tasks
+ * are stolen, so a page isn't bound to the worker that later uses it.
+ */
+inline void FirstTouch(ThreadPool &pool, ecs::Arena &arena, uint64_t bytes) {
+    auto pages = (std::min(bytes, arena.GetCapacity()) + arena.PageSize() - 1) / arena.PageSize();
+    auto grain = std::max<uint64_t>(1, pages / (pool.Size() + 1));
+    ParallelFor(pool, pages, grain, [&](uint64_t first, uint64_t last) {
+        arena.Touch(first * arena.PageSize(), last * arena.PageSize());
+    });
+}
+
+/**
+ * Run a view with ParallelEach if a pool is given, or with SceneView::Each
+ * on the calling thread otherwise.
+ */
+template<class... ComponentTypes, class Func>
+void Each(ThreadPool *pool, const ecs::SceneView<ComponentTypes...> &view, Func &&func) {
+    if (pool != nullptr) {
+        ParallelEach(*pool, view, std::forward<Func>(func));
+    } else {
+        view.Each(std::forward<Func>(func));
+    }
+}
+
+}  // steering
@@ -0,0 +1,257 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Trace logging is compiled out unless the build defines STEERING_TRACE=1.
+// Use it instead of SDL_Log in code that runs per agent. When disabled, the
+// arguments are still type checked but never evaluated.
+#ifndef STEERING_TRACE
+#define STEERING_TRACE 0
+#endif
+
+#if STEERING_TRACE
+#include <SDL.h>
+#define STEERING_TRACE_LOG(...) SDL_Log(__VA_ARGS__)
+#else
+#define STEERING_TRACE_LOG(...) do { if (false) { std::printf(__VA_ARGS__); } } while (0)
+#endif
+
+namespace steering {
+/**
+ * Profiler records scoped timings from any thread. Every thread writes its
+ * events to its own ring buffer without locking; EndFrame collects the
+ * events of the frame into rolling per-name statistics, and optionally into
+ * a trace that can be written in the Chrome trace event format
+ * (chrome://tracing, Perfetto).
+ *
+ * EndFrame must not run at the same time as the scopes it collects, e.g. it
+ * runs after Scheduler::Run has returned.
+ */
+class Profiler {
+public:
+    // Events kept per thread between two EndFrame calls
+    static constexpr size_t RING_SIZE = 4096;
+    // Frames kept for the percentiles
+    static constexpr size_t WINDOW = 128;
+
+    /**
+     * Event is a timed scope, in nanoseconds since the profiler was created.
+     */
+    struct Event {
+        const char *name;
+        uint64_t   start;
+        uint64_t   duration;
+        uint32_t   thread;
+    };
+
+    /**
+     * Scope times the enclosing block. A null profiler records nothing.
+     * The name must outlive the next EndFrame.
+     */
+    class Scope {
+    public:
+        Scope(Profiler *profiler, const char *name)
+            : profiler_(profiler), name_(name) {
+            if (profiler_ != nullptr) {
+                start_ = profiler_->Now();
+            }
+        }
+
+        ~Scope() {
+            if (profiler_ != nullptr) {
+                profiler_->Record(name_, start_, profiler_->Now() - start_);
+            }
+        }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        Profiler  *profiler_{ nullptr };
+        const char    *name_{ nullptr };
+        uint64_t      start_{ 0 };
+    };
+
+    Profiler() = default;
+    Profiler(const Profiler &) = delete;
+    Profiler &operator=(const Profiler &) = delete;
+
+    /**
+     * Get the time in nanoseconds since the profiler was created.
+     */
+    uint64_t Now() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - epoch_).count();
+    }
+
+    /**
+     * Record an event on the calling thread's ring buffer.
+     */
+    void Record(const char *name, uint64_t start, uint64_t duration) {
+        auto &ring = Self();
+        auto head = ring.head.load(std::memory_order_relaxed);
+        ring.events[head % RING_SIZE] = Event{ name, start, duration, ring.thread };
+        ring.head.store(head + 1, std::memory_order_release);
+    }
+
+    /**
+     * Collect the events recorded since the last call. The total time of
+     * every name in the frame is one sample of its statistics.
+     */
+    void EndFrame() {
+        std::map<std::string, double> frame;
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto &ring : rings_) {
+            auto head = ring->head.load(std::memory_order_acquire);
+            // Events overwritten since the last frame are lost
+            auto tail = std::max(ring->tail, head < RING_SIZE ? 0 : head - RING_SIZE);
+            for (; tail < head; tail++) {
+                auto &event = ring->events[tail % RING_SIZE];
+                frame[event.name] += event.duration * 1e-6;
+                if (capturing_) {
+                    trace_.push_back(event);
+                }
+            }
+            ring->tail = head;
+        }
+        for (auto &entry : frame) {
+            auto &stats = stats_[entry.first];
+            if (stats.samples.size() < WINDOW) {
+                stats.samples.push_back(entry.second);
+            } else {
+                stats.samples[stats.next] = entry.second;
+            }
+            stats.next = (stats.next + 1) % WINDOW;
+        }
+    }
+
+    /**
+     * Get a percentile, in [0, 100], of the time in milliseconds a name took
+     * per frame over the last WINDOW frames it was recorded in, or 0 if it
+     * wasn't recorded.
+     */
+    double Percentile(const std::string &name, double percentile) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = stats_.find(name);
+        if (it == stats_.end() || it->second.samples.empty()) {
+            return 0.0;
+        }
+        auto samples = it->second.samples;
+        auto n = static_cast<size_t>(percentile / 100.0 * (samples.size() - 1) + 0.5);
+        std::nth_element(samples.begin(), samples.begin() + n, samples.end());
+        return samples[n];
+    }
+
+    /**
+     * Get the names recorded so far, sorted.
+     */
+    std::vector<std::string> GetNames() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<std::string> names;
+        for (auto &entry : stats_) {
+            names.push_back(entry.first);
+        }
+        return names;
+    }
+
+    /**
+     * Start or stop keeping the collected events for WriteChromeTrace.
+     */
+    void Capture(bool capture) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        capturing_ = capture;
+    }
+
+    /**
+     * Write the captured events as a Chrome trace. Returns false if the file
+     * can't be written.
+     */
+    bool WriteChromeTrace(const std::string &path) const {
+        std::ofstream out(path);
+        if (!out) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        out << "{\"traceEvents\":[";
+        for (size_t i = 0; i < trace_.size(); i++) {
+            auto &event = trace_[i];
+            out << (i == 0 ? "" : ",") << "\n{\"name\":\"" << event.name
+                << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << event.thread
+                << ",\"ts\":" << event.start / 1000.0
+                << ",\"dur\":" << event.duration / 1000.0 << "}";
+        }
+        out << "\n]}\n";
+        return static_cast<bool>(out);
+    }
+
+private:
+    struct Ring {
+        Event                 events[RING_SIZE];
+        std::atomic<uint64_t>   head{ 0 };  // written by the owning thread only
+        uint64_t                tail{ 0 };  // read by EndFrame only
+        uint32_t              thread{ 0 };
+    };
+
+    /**
+     * Cached ring of the calling thread, for the last profiler it used.
+     * Profilers are told apart by id rather than address, which may be
+     * reused.
+     */
+    struct Owner {
+        uint64_t profiler{ 0 };
+        Ring        *ring{ nullptr };
+    };
+
+    /**
+     * Rolling window of the frame times of a name. Once full, next is the
+     * oldest sample, which the next one overwrites.
+     */
+    struct Stats {
+        std::vector<double> samples;
+        size_t                 next{ 0 };
+    };
+
+    static uint64_t NewId() {
+        static std::atomic<uint64_t> counter(1);
+        return counter++;
+    }
+
+    Ring &Self() {
+        static thread_local Owner owner;
+        if (owner.profiler != id_) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto thread = std::this_thread::get_id();
+            auto it = std::find(threads_.begin(), threads_.end(), thread);
+            if (it == threads_.end()) {
+                threads_.push_back(thread);
+                rings_.push_back(std::make_unique<Ring>());
+                rings_.back()->thread = static_cast<uint32_t>(rings_.size() - 1);
+                it = threads_.end() - 1;
+            }
+            owner = Owner{ id_, rings_[it - threads_.begin()].get() };
+        }
+        return *owner.ring;
+    }
+
+    uint64_t                                      id_{ NewId() };
+    std::chrono::steady_clock::time_point      epoch_{ std::chrono::steady_clock::now() };
+    mutable std::mutex                         mutex_{};
+    std::vector<std::thread::id>             threads_{};
+    std::vector<std::unique_ptr<Ring>>         rings_{};  // per thread
+    std::map<std::string, Stats>               stats_{};
+    std::vector<Event>                         trace_{};
+    bool                                   capturing_{ false };
+};
+
+}  // steering
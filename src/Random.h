@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <ECS.h>
+
+namespace steering {
+namespace random {
+/**
+ * Hash a 32-bit integer (lowbias32). Every input bit affects every output
+ * bit, and it only uses 32-bit operations, so loops over it vectorize.
+ */
+inline uint32_t Hash(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+/**
+ * Get the key of the random stream of an entity from its ID and a seed.
+ * Entities get their IDs in the order they are created, so the keys don't
+ * depend on the threads that use them.
+ */
+inline uint32_t Key(ecs::Entity::Id id, uint32_t seed = 0) {
+    auto x = static_cast<uint64_t>(id);
+    return Hash(static_cast<uint32_t>(x) ^ Hash(static_cast<uint32_t>(x >> 32) ^ Hash(seed)));
+}
+
+/**
+ * Get the n-th number of the stream of a key. Streams are counter based:
+ * a number is a hash of the key and its position, so there's no generator
+ * state to share, and numbers can be generated in any order.
+ */
+inline uint32_t At(uint32_t key, uint32_t n) {
+    return Hash(key ^ Hash(n + 0x9e3779b9u));
+}
+
+/**
+ * Map a number to a float in [-1, 1), from its upper 24 bits.
+ */
+inline float Clamped(uint32_t x) {
+    return static_cast<float>(x >> 8) * (2.0f / 16777216.0f) - 1.0f;
+}
+
+/**
+ * Stream is a position in the stream of a key.
+ */
+struct Stream {
+    uint32_t key{ 0 };
+    uint32_t counter{ 0 };
+
+    uint32_t Next() {
+        return At(key, counter++);
+    }
+
+    /**
+     * Get the next number as a float in [-1, 1).
+     */
+    float NextClamped() {
+        return Clamped(Next());
+    }
+};
+
+/**
+ * Generate one jitter vector in [-1, 1)^2 per stream, all at the same
+ * counter: x is the number at the counter and y the next one, like two
+ * NextClamped calls. The loop has no branches, so the compiler can
+ * vectorize it.
+ */
+inline void Jitter(size_t n, const uint32_t *keys, uint32_t counter, float *x, float *y) {
+    for (size_t i = 0; i < n; i++) {
+        x[i] = Clamped(At(keys[i], counter));
+        y[i] = Clamped(At(keys[i], counter + 1));
+    }
+}
+
+}  // random
+}  // steering
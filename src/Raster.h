@@ -0,0 +1,70 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace steering {
+namespace raster {
+/**
+ * Get the pixel offsets of a circle outline around the origin, using the
+ * midpoint circle algorithm. Every pixel appears once.
+ */
+inline std::vector<glm::ivec2> CircleOutline(int radius) {
+    std::vector<glm::ivec2> points;
+    auto x = glm::max(radius, 0);
+    auto y = 0;
+    auto err = 1 - x;
+    while (y <= x) {
+        // One point per octant
+        for (auto p : { glm::ivec2( x,  y), glm::ivec2( y,  x),
+                        glm::ivec2(-y,  x), glm::ivec2(-x,  y),
+                        glm::ivec2(-x, -y), glm::ivec2(-y, -x),
+                        glm::ivec2( y, -x), glm::ivec2( x, -y) }) {
+            points.push_back(p);
+        }
+        y++;
+        if (err < 0) {
+            err += 2 * y + 1;
+        } else {
+            x--;
+            err += 2 * (y - x) + 1;
+        }
+    }
+
+    // The octants share the points on the axes and diagonals
+    auto less = [](glm::ivec2 a, glm::ivec2 b) {
+        return a.y < b.y || (a.y == b.y && a.x < b.x);
+    };
+    std::sort(points.begin(), points.end(), less);
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+    return points;
+}
+
+/**
+ * CircleTable caches the outline of circles per integer radius, since the
+ * shapes drawn every frame keep their radius.
+ */
+class CircleTable {
+public:
+    /**
+     * Get the outline of a circle, generating it on first use.
+     * The returned reference stays valid as long as the table.
+     */
+    const std::vector<glm::ivec2> &Get(int radius) {
+        auto &outline = outlines_[radius];
+        if (outline == nullptr) {
+            outline = std::make_unique<std::vector<glm::ivec2>>(CircleOutline(radius));
+        }
+        return *outline;
+    }
+
+private:
+    std::unordered_map<int, std::unique_ptr<std::vector<glm::ivec2>>> outlines_{};
+};
+
+}  // raster
+}  // steering
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <SDL.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include "Component.h"
+#include "Raster.h"
+
+namespace steering {
+namespace render {
+/**
+ * Batch collects the shapes of a frame in one vertex buffer, with positions
+ * and colors in separate arrays, and submits it with a single
+ * SDL_RenderGeometryRaw call. Lines are drawn as thin quads. Circle outlines
+ * are drawn as pixels, with one SDL_RenderDrawPoints call per run of the
+ * same color. The buffers are reused between frames.
+ */
+class Batch {
+public:
+    /**
+     * Add a line from a to b.
+     */
+    void Line(glm::vec2 a, glm::vec2 b, const component::Color &color, float width = 1.0f) {
+        auto d = b - a;
+        auto length = glm::length(d);
+        if (length < glm::epsilon<float>()) {
+            return;
+        }
+        auto n = glm::vec2(-d.y, d.x) * (width * 0.5f / length);
+        Quad(a + n, a - n, b - n, b + n, color);
+    }
+
+    /**
+     * Add a one pixel point.
+     */
+    void Point(glm::vec2 p, const component::Color &color) {
+        Quad(p, p + glm::vec2(1.0f, 0.0f), p + glm::vec2(1.0f, 1.0f), p + glm::vec2(0.0f, 1.0f), color);
+    }
+
+    /**
+     * Add a circle outline. The radius is rounded to whole pixels.
+     */
+    void Circle(glm::vec2 center, float radius, const component::Color &color) {
+        auto &outline = circles_.Get(static_cast<int>(radius + 0.5f));
+        auto c = glm::ivec2(static_cast<int>(glm::floor(center.x + 0.5f)),
+                            static_cast<int>(glm::floor(center.y + 0.5f)));
+        if (runs_.empty() || !Same(runs_.back().color, color)) {
+            runs_.push_back(Run{ SDL_Color{ color.r, color.g, color.b, color.a }, points_.size() });
+        }
+        for (auto p : outline) {
+            points_.push_back(SDL_Point{ c.x + p.x, c.y + p.y });
+        }
+    }
+
+    /**
+     * Submit the batch to an SDL rendering context and clear it.
+     */
+    void Submit(SDL_Renderer *renderer) {
+        if (!indices_.empty()) {
+            SDL_RenderGeometryRaw(
+                renderer, nullptr,
+                xy_.data(), sizeof(float) * 2,
+                colors_.data(), sizeof(SDL_Color),
+                nullptr, 0,
+                static_cast<int>(colors_.size()),
+                indices_.data(), static_cast<int>(indices_.size()), sizeof(int)
+            );
+        }
+        for (size_t r = 0; r < runs_.size(); r++) {
+            auto first = runs_[r].first;
+            auto last  = r + 1 < runs_.size() ? runs_[r + 1].first : points_.size();
+            auto &c = runs_[r].color;
+            SDL_SetRenderDrawColor(renderer, c.r, c.g, c.b, c.a);
+            SDL_RenderDrawPoints(renderer, points_.data() + first, static_cast<int>(last - first));
+        }
+        Clear();
+    }
+
+    /**
+     * Remove all shapes, keeping the memory.
+     */
+    void Clear() {
+        xy_.clear();
+        colors_.clear();
+        indices_.clear();
+        points_.clear();
+        runs_.clear();
+    }
+
+    /**
+     * Get the number of vertices in the batch.
+     */
+    size_t Size() const {
+        return colors_.size();
+    }
+
+private:
+    /**
+     * A run of points of the same color, from first to the next run.
+     */
+    struct Run {
+        SDL_Color color;
+        size_t    first;
+    };
+
+    static bool Same(const SDL_Color &a, const component::Color &b) {
+        return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+    }
+
+    void Quad(glm::vec2 p0, glm::vec2 p1, glm::vec2 p2, glm::vec2 p3, const component::Color &color) {
+        auto base = static_cast<int>(colors_.size());
+        for (auto p : { p0, p1, p2, p3 }) {
+            xy_.push_back(p.x);
+            xy_.push_back(p.y);
+            colors_.push_back(SDL_Color{ color.r, color.g, color.b, color.a });
+        }
+        for (auto i : { 0, 1, 2, 0, 2, 3 }) {
+            indices_.push_back(base + i);
+        }
+    }
+
+    std::vector<float>         xy_{};  // x, y per vertex
+    std::vector<SDL_Color> colors_{};
+    std::vector<int>      indices_{};  // two triangles per quad
+    std::vector<SDL_Point> points_{};
+    std::vector<Run>         runs_{};
+    raster::CircleTable   circles_{};
+};
+
+}  // render
+}  // steering
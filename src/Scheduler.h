@@ -0,0 +1,174 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <typeindex>
+#include <vector>
+
+#include <ECS.h>
+
+#include "Profiler.h"
+#include "ThreadPool.h"
+
+namespace steering {
+/**
+ * Component types (or any other shared state, e.g. spatial::Grid) a system
+ * reads. Declaring ecs::Scene means the system may touch anything, e.g. to
+ * add or remove entities, and runs alone.
+ */
+template<class... Types>
+struct Reads {};
+
+/**
+ * Component types (or any other shared state) a system writes.
+ */
+template<class... Types>
+struct Writes {};
+
+/**
+ * The front buffer of a double-buffered component type, which systems read
+ * while others write the live components.
+ */
+template<class T>
+struct Front {};
+
+/**
+ * Scheduler runs systems on a ThreadPool. Every system declares what it
+ * reads and writes; a system depends on the earlier added systems it
+ * conflicts with, i.e. one of them writes what the other reads or writes.
+ * Systems without a path between them in that graph run at the same time,
+ * and conflicting systems keep the order in which they were added.
+ */
+class Scheduler {
+public:
+    /**
+     * Constructor.
+     */
+    explicit Scheduler(ThreadPool &pool) : pool_(&pool) {}
+
+    /**
+     * Add a system. The system is a function taking no arguments.
+     */
+    template<class... R, class... W, class Func>
+    void Add(std::string name, Reads<R...>, Writes<W...>, Func &&func) {
+        auto system = std::make_unique<System>();
+        system->name_ = std::move(name);
+        system->reads_ = { std::type_index(typeid(R)) ... };
+        system->writes_ = { std::type_index(typeid(W)) ... };
+        system->func_ = std::forward<Func>(func);
+
+        for (size_t i = 0; i < systems_.size(); i++) {
+            if (Conflicts(*systems_[i], *system)) {
+                systems_[i]->dependents_.push_back(systems_.size());
+                system->dependencies_++;
+            }
+        }
+        systems_.push_back(std::move(system));
+    }
+
+    /**
+     * Run every system once and wait until all of them are done. The calling
+     * thread helps running the systems while it waits.
+     */
+    void Run() {
+        done_ = 0;
+        for (auto &system : systems_) {
+            system->remaining_ = system->dependencies_;
+        }
+        for (size_t i = 0; i < systems_.size(); i++) {
+            if (systems_[i]->dependencies_ == 0) {
+                Submit(i);
+            }
+        }
+        pool_->Wait([this]() { return done_ == systems_.size(); });
+    }
+
+    /**
+     * Time every system with a profiler, or stop timing them with nullptr.
+     * The profiler must outlive the scheduler.
+     */
+    void SetProfiler(Profiler *profiler) {
+        profiler_ = profiler;
+    }
+
+    /**
+     * Get the number of systems.
+     */
+    size_t Size() const {
+        return systems_.size();
+    }
+
+    /**
+     * Get the name of a system.
+     */
+    const std::string &GetName(size_t i) const {
+        return systems_[i]->name_;
+    }
+
+    /**
+     * Get the systems that wait for a system to finish.
+     */
+    const std::vector<size_t> &GetDependents(size_t i) const {
+        return systems_[i]->dependents_;
+    }
+
+private:
+    struct System {
+        std::string                    name_{};
+        std::vector<std::type_index>  reads_{};
+        std::vector<std::type_index> writes_{};
+        std::function<void()>          func_{};
+        std::vector<size_t>      dependents_{};
+        size_t                 dependencies_{ 0 };
+        std::atomic<size_t>       remaining_{ 0 };
+    };
+
+    static bool Overlaps(const std::vector<std::type_index> &a,
+                         const std::vector<std::type_index> &b) {
+        for (auto &type : a) {
+            if (std::find(b.begin(), b.end(), type) != b.end()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static bool Exclusive(const System &system) {
+        std::vector<std::type_index> scene = { std::type_index(typeid(ecs::Scene)) };
+        return Overlaps(system.reads_, scene) || Overlaps(system.writes_, scene);
+    }
+
+    static bool Conflicts(const System &a, const System &b) {
+        return Exclusive(a) || Exclusive(b) ||
+               Overlaps(a.writes_, b.reads_) ||
+               Overlaps(a.writes_, b.writes_) ||
+               Overlaps(a.reads_, b.writes_);
+    }
+
+    void Submit(size_t i) {
+        pool_->Submit([this, i]() {
+            auto &system = *systems_[i];
+            {
+                Profiler::Scope scope(profiler_, system.name_.c_str());
+                system.func_();
+            }
+            for (auto dependent : system.dependents_) {
+                if (--systems_[dependent]->remaining_ == 0) {
+                    Submit(dependent);
+                }
+            }
+            done_++;
+        });
+    }
+
+    ThreadPool                          *pool_{ nullptr };
+    Profiler                        *profiler_{ nullptr };
+    std::vector<std::unique_ptr<System>> systems_{};
+    std::atomic<size_t>                    done_{ 0 };
+};
+
+}  // steering
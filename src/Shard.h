@@ -0,0 +1,739 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include <glm/glm.hpp>
+
+#include <ECS.h>
+
+#include "Component.h"
+
+namespace steering {
+namespace shard {
+
+typedef std::vector<uint8_t> Message;
+
+/**
+ * Layout splits the toroidal world of update::Wraparound into columns x rows
+ * shards of equal size. The agents within halo of a shard's border are
+ * mirrored to the shards across it, so halo must be smaller than a shard,
+ * e.g. the largest neighbor radius of the behaviors.
+ */
+struct Layout {
+    glm::vec2 world{ glm::vec2(0.0f) };
+    uint32_t columns{ 1 };
+    uint32_t    rows{ 1 };
+    float       halo{ 50.0f };
+
+    uint32_t Count() const {
+        return columns * rows;
+    }
+
+    /**
+     * Get the shard owning a position, wrapped around the world's edges.
+     */
+    uint32_t ShardOf(glm::vec2 position) const {
+        auto x = Wrap(static_cast<int64_t>(glm::floor(position.x * columns / world.x)), columns);
+        auto y = Wrap(static_cast<int64_t>(glm::floor(position.y * rows / world.y)), rows);
+        return y * columns + x;
+    }
+
+    /**
+     * Get the shards next to one, including the diagonal ones, in
+     * ascending order and without the shard itself.
+     */
+    std::vector<uint32_t> Neighbors(uint32_t shard) const {
+        std::vector<uint32_t> neighbors;
+        auto x = static_cast<int64_t>(shard % columns);
+        auto y = static_cast<int64_t>(shard / columns);
+        for (int64_t dy = -1; dy <= 1; dy++) {
+            for (int64_t dx = -1; dx <= 1; dx++) {
+                auto n = Wrap(y + dy, rows) * columns + Wrap(x + dx, columns);
+                if (n != shard && std::find(neighbors.begin(), neighbors.end(), n) == neighbors.end()) {
+                    neighbors.push_back(n);
+                }
+            }
+        }
+        std::sort(neighbors.begin(), neighbors.end());
+        return neighbors;
+    }
+
+private:
+    static uint32_t Wrap(int64_t i, uint32_t n) {
+        return static_cast<uint32_t>(((i % n) + n) % n);
+    }
+};
+
+/**
+ * Transport carries the messages between the shards, one per tick for
+ * every neighbor and in both directions.
+ */
+class Transport {
+public:
+    virtual ~Transport() = default;
+
+    /**
+     * Send out[i] to the shard peers[i] and receive in[i] from it, for
+     * every peer. Blocks until every message is received. Returns false if
+     * a peer can't be reached.
+     */
+    virtual bool Exchange(const std::vector<uint32_t> &peers,
+                          const std::vector<Message> &out,
+                          std::vector<Message> &in) = 0;
+};
+
+/**
+ * Loopback holds the mailboxes between the shards of one process, e.g.
+ * running in their own threads. This class is thread-safe.
+ */
+class Loopback {
+public:
+    explicit Loopback(uint32_t shards) : shards_(shards), boxes_(shards * shards) {}
+
+    void Post(uint32_t from, uint32_t to, const Message &message) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            boxes_[from * shards_ + to].push_back(message);
+        }
+        ready_.notify_all();
+    }
+
+    /**
+     * Take the oldest message from a shard to another, waiting for it.
+     */
+    Message Take(uint32_t from, uint32_t to) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto &box = boxes_[from * shards_ + to];
+        ready_.wait(lock, [&]() { return !box.empty(); });
+        auto message = std::move(box.front());
+        box.pop_front();
+        return message;
+    }
+
+private:
+    uint32_t                        shards_{ 0 };
+    std::vector<std::deque<Message>> boxes_{};  // by sender, then receiver
+    std::mutex                       mutex_;
+    std::condition_variable          ready_;
+};
+
+/**
+ * LoopbackTransport is the end of one shard at a Loopback.
+ */
+class LoopbackTransport : public Transport {
+public:
+    LoopbackTransport(Loopback &loopback, uint32_t shard)
+        : loopback_(loopback),
+          shard_(shard) {}
+
+    bool Exchange(const std::vector<uint32_t> &peers,
+                  const std::vector<Message> &out,
+                  std::vector<Message> &in) override {
+        for (size_t i = 0; i < peers.size(); i++) {
+            loopback_.Post(shard_, peers[i], out[i]);
+        }
+        in.resize(peers.size());
+        for (size_t i = 0; i < peers.size(); i++) {
+            in[i] = loopback_.Take(peers[i], shard_);
+        }
+        return true;
+    }
+
+private:
+    Loopback &loopback_;
+    uint32_t     shard_{ 0 };
+};
+
+#if defined(__unix__) || defined(__APPLE__)
+/**
+ * SocketTransport carries the messages over connected stream sockets, one
+ * per peer, e.g. made with socketpair before forking or with connect and
+ * accept between nodes. A message is framed by its length. The writes and
+ * reads of all the peers are interleaved with poll, so that two shards
+ * sending large messages to each other don't both block on a full socket.
+ */
+class SocketTransport : public Transport {
+public:
+    /**
+     * Take the sockets, indexed by peer shard; -1 stands for no peer.
+     */
+    explicit SocketTransport(std::vector<int> sockets) : sockets_(std::move(sockets)) {}
+
+    ~SocketTransport() override {
+        for (auto fd : sockets_) {
+            if (0 <= fd) {
+                ::close(fd);
+            }
+        }
+    }
+
+    SocketTransport(const SocketTransport &) = delete;
+    SocketTransport &operator=(const SocketTransport &) = delete;
+
+    bool Exchange(const std::vector<uint32_t> &peers,
+                  const std::vector<Message> &out,
+                  std::vector<Message> &in) override {
+        struct Pending {
+            int           fd{ -1 };
+            uint64_t  length{ 0 };
+            size_t   written{ 0 };  // bytes of the frame, length first
+            size_t      read{ 0 };
+            uint8_t   header[sizeof(uint64_t)]{};
+        };
+        std::vector<Pending> pending(peers.size());
+        std::vector<pollfd> fds(peers.size());
+        in.assign(peers.size(), Message());
+        for (size_t i = 0; i < peers.size(); i++) {
+            if (sockets_.size() <= peers[i] || sockets_[peers[i]] < 0) {
+                return false;
+            }
+            pending[i].fd = sockets_[peers[i]];
+            pending[i].length = out[i].size();
+        }
+
+        constexpr size_t HEADER = sizeof(uint64_t);
+        auto done = [&](const Pending &p, size_t i) {
+            return p.written == HEADER + out[i].size() &&
+                   HEADER <= p.read && p.read == HEADER + in[i].size();
+        };
+        while (true) {
+            size_t active = 0;
+            for (size_t i = 0; i < peers.size(); i++) {
+                auto &p = pending[i];
+                fds[i].fd = done(p, i) ? -1 : p.fd;
+                fds[i].events = 0;
+                fds[i].revents = 0;
+                if (p.written < HEADER + out[i].size()) {
+                    fds[i].events |= POLLOUT;
+                }
+                if (p.read < HEADER || p.read < HEADER + in[i].size()) {
+                    fds[i].events |= POLLIN;
+                }
+                active += fds[i].fd < 0 ? 0 : 1;
+            }
+            if (active == 0) {
+                return true;
+            }
+            if (::poll(fds.data(), static_cast<nfds_t>(fds.size()), -1) < 0) {
+                return false;
+            }
+
+            for (size_t i = 0; i < peers.size(); i++) {
+                auto &p = pending[i];
+                if (fds[i].fd < 0) {
+                    continue;
+                }
+                if (fds[i].revents & POLLOUT) {
+                    const uint8_t *data;
+                    size_t bytes;
+                    if (p.written < HEADER) {
+                        data = reinterpret_cast<const uint8_t *>(&p.length) + p.written;
+                        bytes = HEADER - p.written;
+                    } else {
+                        data = out[i].data() + (p.written - HEADER);
+                        bytes = out[i].size() - (p.written - HEADER);
+                    }
+                    auto n = ::send(p.fd, data, bytes, SEND_FLAGS);
+                    if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                        return false;
+                    }
+                    p.written += n < 0 ? 0 : static_cast<size_t>(n);
+                }
+                if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+                    uint8_t *data;
+                    size_t bytes;
+                    if (p.read < HEADER) {
+                        data = p.header + p.read;
+                        bytes = HEADER - p.read;
+                    } else {
+                        data = in[i].data() + (p.read - HEADER);
+                        bytes = in[i].size() - (p.read - HEADER);
+                    }
+                    if (bytes == 0) {
+                        continue;
+                    }
+                    auto n = ::recv(p.fd, data, bytes, 0);
+                    if (n <= 0) {
+                        return false;
+                    }
+                    p.read += static_cast<size_t>(n);
+                    if (p.read == HEADER) {
+                        uint64_t length;
+                        std::memcpy(&length, p.header, sizeof(length));
+                        in[i].resize(length);
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    // A send takes what fits in the socket buffer rather than waiting for
+    // the peer, and a closed peer fails the exchange rather than raising
+    // SIGPIPE
+#ifdef MSG_NOSIGNAL
+    static constexpr int SEND_FLAGS = MSG_DONTWAIT | MSG_NOSIGNAL;
+#else
+    static constexpr int SEND_FLAGS = MSG_DONTWAIT;
+#endif
+
+    std::vector<int> sockets_{};
+};
+#endif
+
+typedef uint64_t Handle;
+
+constexpr Handle NO_HANDLE(static_cast<Handle>(-1));
+// Low bits of a handle counting the agents adopted by its shard
+constexpr uint32_t SEQUENCE_BITS(40);
+
+/**
+ * Get the field of a component referring to another agent, translated
+ * through the handles when the component migrates, or nullptr if it has
+ * none. Other references, e.g. to the circles of Wander, aren't translated.
+ */
+template<class T>
+std::nullptr_t Link(T &) {
+    return nullptr;
+}
+
+inline ecs::Entity::Id *Link(component::Pursuit &p) {
+    return &p.evaderId;
+}
+
+inline ecs::Entity::Id *Link(component::Evade &e) {
+    return &e.pursuerId;
+}
+
+template<class T>
+void Put(Message &message, const T &value) {
+    auto offset = message.size();
+    message.resize(offset + sizeof(T));
+    std::memcpy(message.data() + offset, &value, sizeof(T));
+}
+
+template<class T>
+bool Get(const uint8_t *&in, const uint8_t *end, T &value) {
+    if (static_cast<size_t>(end - in) < sizeof(T)) {
+        return false;
+    }
+    std::memcpy(&value, in, sizeof(T));
+    in += sizeof(T);
+    return true;
+}
+
+/**
+ * Header of a message: the migrants, then the ghosts.
+ */
+struct MessageHeader {
+    uint64_t migrants{ 0 };
+    uint64_t   ghosts{ 0 };
+};
+
+}  // shard
+
+/**
+ * Shard simulates the agents in its part of the world with its own scene,
+ * e.g. in its own process or node, and exchanges the agents at its borders
+ * with the neighbor shards once per tick, after they moved:
+ *
+ * - An agent that crossed into a neighbor migrates to it: its components
+ *   of the listed types are sent, and it stays behind as a ghost like the
+ *   ones received, with only its Transform, Move and Global of any type.
+ * - An agent within the halo of a neighbor is mirrored to it as a ghost: an
+ *   entity with a Transform, a Move, a Global and a Ghost component, which
+ *   the behaviors read like any other agent but never steer. A ghost that
+ *   isn't refreshed by the next exchange is removed.
+ *
+ * Agents are known across the shards by their Global handle. The Pursuit
+ * and Evade targets of a migrant are resolved through it to the owned agent
+ * or the ghost in the receiving scene, if any.
+ *
+ * The component types must be trivially copyable and the agents should move
+ * less than a shard per tick; one that moves past the neighbors stays in
+ * its shard, and Exchange returns false. Agents without a Global handle, e.g. the
+ * ones that own no position, stay in their shard.
+ */
+template<class... ComponentTypes>
+class Shard {
+public:
+    static_assert((std::is_trivially_copyable<ComponentTypes>::value && ...));
+    static_assert(sizeof...(ComponentTypes) <= 64);
+
+    Shard(const shard::Layout &layout, uint32_t index, shard::Transport &transport)
+        : layout_(layout),
+          index_(index),
+          transport_(transport),
+          neighbors_(layout.Neighbors(index)) {}
+
+    /**
+     * Give an agent of this shard a Global handle, e.g. after creating it.
+     * Throws std::invalid_argument if it already has one.
+     */
+    shard::Handle Adopt(ecs::Scene &scene, ecs::Entity::Id id) {
+        if (scene.HasComponent<component::Global>(id)) {
+            throw std::invalid_argument("Shard::Adopt: the agent already has a Global handle");
+        }
+        auto handle = (static_cast<shard::Handle>(index_) << shard::SEQUENCE_BITS) | sequence_++;
+        scene.AddComponent<component::Global>(id, handle);
+        locals_[handle] = id;
+        return handle;
+    }
+
+    /**
+     * Get the agent or ghost of the scene with a handle, or an invalid ID.
+     */
+    ecs::Entity::Id Resolve(shard::Handle handle) const {
+        auto it = locals_.find(handle);
+        return it == locals_.end() ? static_cast<ecs::Entity::Id>(-1) : it->second;
+    }
+
+    /**
+     * Get the handle of an agent, or NO_HANDLE if it has none.
+     */
+    shard::Handle GetHandle(ecs::Scene &scene, ecs::Entity::Id id) const {
+        if (!ecs::Entity::IsValid(id) || !scene.IsAlive(id) || !scene.HasComponent<component::Global>(id)) {
+            return shard::NO_HANDLE;
+        }
+        return scene.GetComponent<component::Global>(id)->handle;
+    }
+
+    /**
+     * Send the migrants and the ghosts to the neighbors and apply theirs.
+     * Returns false if the transport fails or a message is malformed;
+     * the received messages are then ignored as a whole. Also returns
+     * false, after the exchange, if an agent moved past the neighbors: it
+     * then stays in this shard.
+     */
+    bool Exchange(ecs::Scene &scene) {
+        auto exchange = ++exchanges_;
+        auto packed = Pack(scene, exchange);
+        if (!transport_.Exchange(neighbors_, out_, in_)) {
+            return false;
+        }
+        for (auto &message : in_) {
+            if (!Parse(message, [](shard::Handle, const uint8_t *) {}, [](shard::Handle, const uint8_t *) {})) {
+                return false;
+            }
+        }
+        Unpack(scene, exchange);
+        return packed;
+    }
+
+    uint32_t GetIndex() const {
+        return index_;
+    }
+
+    const std::vector<uint32_t> &GetNeighbors() const {
+        return neighbors_;
+    }
+
+    /**
+     * Get the number of agents received by the last exchange.
+     */
+    uint64_t GetArrived() const {
+        return arrived_;
+    }
+
+private:
+    static constexpr size_t COUNT = sizeof...(ComponentTypes);
+    static constexpr size_t NO_SLOT = static_cast<size_t>(-1);
+
+    /**
+     * Get the peer slot of a shard, or NO_SLOT if it isn't a neighbor.
+     */
+    size_t Slot(uint32_t shard) const {
+        auto it = std::lower_bound(neighbors_.begin(), neighbors_.end(), shard);
+        if (it == neighbors_.end() || *it != shard) {
+            return NO_SLOT;
+        }
+        return static_cast<size_t>(it - neighbors_.begin());
+    }
+
+    /**
+     * Write the migrants and the ghosts for every neighbor, and leave the
+     * migrants behind as ghosts. Returns false if an agent moved past the
+     * neighbors; it isn't sent anywhere and keeps being owned here.
+     */
+    bool Pack(ecs::Scene &scene, uint64_t exchange) {
+        auto packed = true;
+        auto peers = neighbors_.size();
+        std::vector<shard::MessageHeader> headers(peers);
+        migrants_.resize(peers);
+        ghosts_.resize(peers);
+        for (size_t p = 0; p < peers; p++) {
+            migrants_[p].clear();
+            ghosts_[p].clear();
+        }
+
+        leaving_.clear();
+        ecs::SceneView<component::Global, component::Transform>(scene).Each([&](
+                ecs::Entity::Id         id,
+                component::Global      &g,
+                component::Transform   &t) {
+            auto owner = layout_.ShardOf(t.position);
+            if (owner == index_ || scene.HasComponent<component::Ghost>(id)) {
+                return;
+            }
+            auto p = Slot(owner);
+            if (p == NO_SLOT) {
+                packed = false;
+                return;
+            }
+            auto &message = migrants_[p];
+            shard::Put(message, g.handle);
+            uint64_t mask = 0;
+            size_t n = 0;
+            ((mask |= scene.HasComponent<ComponentTypes>(id) ? 1ull << n : 0ull, n++), ...);
+            shard::Put(message, mask);
+            (PutComponent<ComponentTypes>(scene, id, message), ...);
+            headers[p].migrants++;
+            leaving_.emplace_back(id, owner);
+        });
+        for (auto &leaving : leaving_) {
+            Strip(scene, leaving.first);
+            scene.AddComponent<component::Ghost>(leaving.first, leaving.second, exchange);
+        }
+
+        ecs::SceneView<component::Global, component::Transform, component::Move>(scene).Each([&](
+                ecs::Entity::Id         id,
+                component::Global      &g,
+                component::Transform   &t,
+                component::Move        &m) {
+            if (scene.HasComponent<component::Ghost>(id)) {
+                return;
+            }
+            uint32_t seen[9];
+            size_t count = 0;
+            for (auto dy = -1; dy <= 1; dy++) {
+                for (auto dx = -1; dx <= 1; dx++) {
+                    auto shard = layout_.ShardOf(t.position + glm::vec2(static_cast<float>(dx), static_cast<float>(dy)) * layout_.halo);
+                    if (shard == index_ || std::find(seen, seen + count, shard) != seen + count) {
+                        continue;
+                    }
+                    seen[count++] = shard;
+                    auto p = Slot(shard);
+                    if (p == NO_SLOT) {
+                        continue;
+                    }
+                    shard::Put(ghosts_[p], g.handle);
+                    shard::Put(ghosts_[p], t);
+                    shard::Put(ghosts_[p], m);
+                    headers[p].ghosts++;
+                }
+            }
+        });
+
+        out_.resize(peers);
+        for (size_t p = 0; p < peers; p++) {
+            out_[p].clear();
+            shard::Put(out_[p], headers[p]);
+            out_[p].insert(out_[p].end(), migrants_[p].begin(), migrants_[p].end());
+            out_[p].insert(out_[p].end(), ghosts_[p].begin(), ghosts_[p].end());
+        }
+        return packed;
+    }
+
+    /**
+     * Apply the received messages: claim an entity for every agent first,
+     * so that the links of the migrants can refer to any of them, then
+     * write the migrants' components, and remove the stale ghosts.
+     */
+    void Unpack(ecs::Scene &scene, uint64_t exchange) {
+        arrived_ = 0;
+        for (size_t p = 0; p < in_.size(); p++) {
+            auto owner = neighbors_[p];
+            Parse(in_[p], [&](shard::Handle handle, const uint8_t *) {
+                auto id = Resolve(handle);
+                if (ecs::Entity::IsValid(id) && scene.IsAlive(id)) {
+                    if (scene.HasComponent<component::Ghost>(id)) {
+                        scene.RemoveComponent<component::Ghost>(id);
+                    }
+                } else {
+                    id = scene.NewEntity();
+                    scene.AddComponent<component::Global>(id, handle);
+                    locals_[handle] = id;
+                }
+                arrived_++;
+            }, [&](shard::Handle handle, const uint8_t *record) {
+                component::Transform t;
+                component::Move m;
+                std::memcpy(&t, record, sizeof(t));
+                std::memcpy(&m, record + sizeof(t), sizeof(m));
+                auto id = Resolve(handle);
+                if (ecs::Entity::IsValid(id) && scene.IsAlive(id)) {
+                    auto ghost = scene.HasComponent<component::Ghost>(id) ?
+                                 scene.GetComponent<component::Ghost>(id) : nullptr;
+                    if (ghost != nullptr) {
+                        *scene.GetComponent<component::Transform>(id) = t;
+                        *scene.GetComponent<component::Move>(id) = m;
+                        scene.MarkChanged<component::Transform>(id);
+                        ghost->owner = owner;
+                        ghost->exchange = exchange;
+                    }
+                    return;
+                }
+                id = scene.NewEntity();
+                scene.AddComponent<component::Global>(id, handle);
+                scene.AddComponent<component::Transform>(id, t);
+                scene.AddComponent<component::Move>(id, m);
+                scene.AddComponent<component::Ghost>(id, owner, exchange);
+                locals_[handle] = id;
+            });
+        }
+
+        for (auto &message : in_) {
+            Parse(message, [&](shard::Handle handle, const uint8_t *record) {
+                auto id = Resolve(handle);
+                uint64_t mask;
+                std::memcpy(&mask, record, sizeof(mask));
+                record += sizeof(mask);
+                size_t n = 0;
+                (GetComponent<ComponentTypes>(scene, id, (mask >> n++) & 1, record), ...);
+            }, [](shard::Handle, const uint8_t *) {});
+        }
+
+        stale_.clear();
+        ecs::SceneView<component::Global, component::Ghost>(scene).Each([&](
+                ecs::Entity::Id     id,
+                component::Global  &g,
+                component::Ghost   &ghost) {
+            if (ghost.exchange < exchange) {
+                stale_.emplace_back(id, g.handle);
+            }
+        });
+        for (auto &stale : stale_) {
+            scene.RemoveEntity(stale.first);
+            locals_.erase(stale.second);
+        }
+    }
+
+    /**
+     * Walk the records of a message, calling migrant(handle, record) with
+     * the record's mask and components, and ghost(handle, record) with its
+     * Transform and Move. Returns false if the message is malformed.
+     */
+    template<class OnMigrant, class OnGhost>
+    static bool Parse(const shard::Message &message, OnMigrant &&migrant, OnGhost &&ghost) {
+        const uint8_t *in = message.data();
+        const uint8_t *end = in + message.size();
+        shard::MessageHeader header;
+        if (!shard::Get(in, end, header)) {
+            return false;
+        }
+        for (uint64_t i = 0; i < header.migrants; i++) {
+            shard::Handle handle;
+            uint64_t mask;
+            if (!shard::Get(in, end, handle)) {
+                return false;
+            }
+            auto record = in;
+            if (!shard::Get(in, end, mask)) {
+                return false;
+            }
+            size_t bytes = 0;
+            size_t n = 0;
+            ((bytes += (mask >> n++) & 1 ? Bytes<ComponentTypes>() : 0), ...);
+            if (static_cast<size_t>(end - in) < bytes) {
+                return false;
+            }
+            in += bytes;
+            migrant(handle, record);
+        }
+        constexpr size_t GHOST = sizeof(component::Transform) + sizeof(component::Move);
+        for (uint64_t i = 0; i < header.ghosts; i++) {
+            shard::Handle handle;
+            if (!shard::Get(in, end, handle) || static_cast<size_t>(end - in) < GHOST) {
+                return false;
+            }
+            ghost(handle, in);
+            in += GHOST;
+        }
+        return in == end;
+    }
+
+    /**
+     * Get the bytes of a migrated component: the component, then the
+     * handle of its link if it has one.
+     */
+    template<class T>
+    static constexpr size_t Bytes() {
+        using Field = decltype(shard::Link(std::declval<T &>()));
+        return sizeof(T) + (std::is_same<Field, std::nullptr_t>::value ? 0 : sizeof(shard::Handle));
+    }
+
+    template<class T>
+    void PutComponent(ecs::Scene &scene, ecs::Entity::Id id, shard::Message &message) const {
+        if (!scene.HasComponent<T>(id)) {
+            return;
+        }
+        auto &component = *scene.GetComponent<T>(id);
+        shard::Put(message, component);
+        if constexpr (Bytes<T>() != sizeof(T)) {
+            shard::Put(message, GetHandle(scene, *shard::Link(component)));
+        }
+    }
+
+    template<class T>
+    void GetComponent(ecs::Scene &scene, ecs::Entity::Id id, bool present, const uint8_t *&record) {
+        if (!present) {
+            return;
+        }
+        T component;
+        std::memcpy(&component, record, sizeof(T));
+        record += sizeof(T);
+        if constexpr (Bytes<T>() != sizeof(T)) {
+            shard::Handle handle;
+            std::memcpy(&handle, record, sizeof(handle));
+            record += sizeof(handle);
+            *shard::Link(component) = Resolve(handle);
+        }
+        scene.AddComponent<T>(id, component);
+        scene.MarkChanged<T>(id);
+    }
+
+    /**
+     * Remove the components of a migrant left behind as a ghost, listed or
+     * not, but the ones a received ghost has, so that it's never steered.
+     */
+    static void Strip(ecs::Scene &scene, ecs::Entity::Id id) {
+        scene.RemoveComponentsExcept(id, ecs::Component::MaskOf<component::Transform,
+                                                                component::Move,
+                                                                component::Global>());
+    }
+
+    shard::Layout                                           layout_{};
+    uint32_t                                                 index_{ 0 };
+    shard::Transport                                    &transport_;
+    std::vector<uint32_t>                                neighbors_{};
+    uint64_t                                              sequence_{ 0 };
+    uint64_t                                             exchanges_{ 0 };
+    uint64_t                                               arrived_{ 0 };
+    std::unordered_map<shard::Handle, ecs::Entity::Id>      locals_{};  // agents and ghosts by handle
+    std::vector<shard::Message>                                out_{};  // by neighbor
+    std::vector<shard::Message>                                 in_{};
+    std::vector<shard::Message>                           migrants_{};
+    std::vector<shard::Message>                             ghosts_{};
+    std::vector<std::pair<ecs::Entity::Id, uint32_t>>      leaving_{};  // migrants and their new shard
+    std::vector<std::pair<ecs::Entity::Id, shard::Handle>>   stale_{};  // ghosts to remove
+};
+
+}  // steering
@@ -0,0 +1,329 @@
+#include "Simulation.h"
+
+#include <cstdint>
+#include <random>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include <ECS.h>
+
+#include "Checkpoint.h"
+#include "Component.h"
+#include "System.h"
+
+namespace steering {
+namespace {
+
+// Every component type of the agents
+typedef Checkpoint<component::Transform,
+                   component::Move,
+                   component::SteeringForce,
+                   component::Color,
+                   component::Triangle,
+                   component::Crosshair,
+                   component::Circle,
+                   component::Seek,
+                   component::Flee,
+                   component::Arrive,
+                   component::Pursuit,
+                   component::Evade,
+                   component::Wander,
+                   component::Separation,
+                   component::Alignment,
+                   component::Cohesion,
+                   component::ObstacleAvoidance,
+                   component::WallAvoidance> SceneCheckpoint;
+
+}  // namespace
+
+void Simulation::Init() {
+    // Keep Transform, Move and SteeringForce of the agents in the same pool rows
+    scene_.Group<component::Transform,
+                 component::Move,
+                 component::SteeringForce>();
+
+    // Pursuit and Evade read the other agent from the front buffers
+    scene_.DoubleBuffer<component::Transform>();
+    scene_.DoubleBuffer<component::Move>();
+
+    // Wraparound only visits the entities that moved, and the behaviors
+    // the agents due for a steering update, which the settled ones aren't
+    scene_.TrackChanges<component::Transform>();
+    scene_.TrackChanges<component::Move>();
+    scene_.TrackChanges<component::SteeringForce>();
+
+    auto target = scene_.NewEntity();
+    auto circle = scene_.NewEntity();
+    scene_.AddComponent<component::Circle>(
+        target,
+        5.0f    // radius
+    );
+    scene_.AddComponent<component::Circle>(
+        circle,
+        25.0f   // radius (could be changed)
+    );
+    scene_.AddComponent<component::Transform>(
+        target,
+        glm::vec2(0.0f, 0.0f),
+        glm::vec2(0.0f, -1.0f),
+        glm::vec2(1.0f, 1.0f)
+    );
+    scene_.AddComponent<component::Transform>(
+        circle,
+        glm::vec2(0.0f, 0.0f),
+        glm::vec2(0.0f, -1.0f),
+        glm::vec2(1.0f, 1.0f)
+    );
+    scene_.AddComponent<component::Color>(target, 255, 0, 0, 255);
+    scene_.AddComponent<component::Color>(circle, 0, 255, 0, 255);
+
+    auto wander = scene_.NewEntity();
+    auto agent = scene_.NewEntity();
+    scene_.AddComponent<component::Wander>(
+        wander,
+        target,
+        circle,
+         25.0f, // radius
+         35.0f, // distance
+        350.0f  // jitter
+    );
+    scene_.AddComponent<component::Triangle>(
+        wander,
+        10.0f // radius
+    );
+    scene_.AddComponent<component::Transform>(
+        wander,
+        glm::vec2(380.0f, 380.0f), // position
+        glm::vec2(0.0f, -1.0f),    // rotation (head)
+        glm::vec2(0.75f, 1.0f)     // scale
+    );
+    scene_.AddComponent<component::Move>(
+        wander,
+        glm::vec2(0.0f, 0.0f), // velocity
+          1.0f, // mass
+        200.0f, // max speed
+        100.0f  // max force
+    );
+    scene_.AddComponent<component::SteeringForce>(wander);
+    scene_.AddComponent<component::Color>(wander, 0, 0, 255, 255);
+
+    scene_.AddComponent<component::Pursuit>(agent, wander);
+    scene_.AddComponent<component::Triangle>(
+        agent,
+        15.0f // radius
+    );
+    scene_.AddComponent<component::Transform>(
+        agent,
+        glm::vec2(125.0f, 125.0f), // position
+        glm::vec2(0.0f, -1.0f),    // rotation (head)
+        glm::vec2(0.75f, 1.0f)     // scale
+    );
+    scene_.AddComponent<component::Move>(
+        agent,
+        glm::vec2(0.0f, 0.0f), // velocity
+          1.0f, // mass
+        150.0f, // max speed
+         85.0f  // max force
+    );
+    scene_.AddComponent<component::SteeringForce>(agent);
+    scene_.AddComponent<component::Color>(agent, 255, 0, 0, 255);
+
+    // Static obstacles and walls the flock steers around
+    obstacles_ = spatial::Obstacles(
+        {
+            spatial::Obstacle{ glm::vec2( 360.0f,  360.0f), 40.0f },
+            spatial::Obstacle{ glm::vec2(1080.0f,  360.0f), 60.0f },
+            spatial::Obstacle{ glm::vec2( 720.0f,  720.0f), 80.0f },
+            spatial::Obstacle{ glm::vec2( 360.0f, 1080.0f), 60.0f },
+            spatial::Obstacle{ glm::vec2(1080.0f, 1080.0f), 40.0f },
+        },
+        {
+            spatial::Wall(glm::vec2( 200.0f, 720.0f), glm::vec2( 500.0f, 720.0f)),
+            spatial::Wall(glm::vec2( 940.0f, 720.0f), glm::vec2(1240.0f, 720.0f)),
+        }
+    );
+
+    // Flock wandering around the world
+    std::mt19937 engine(0);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    ecs::Prefab<component::WallAvoidance,
+                component::ObstacleAvoidance,
+                component::Separation,
+                component::Alignment,
+                component::Cohesion,
+                component::Triangle,
+                component::Transform,
+                component::Move,
+                component::SteeringForce,
+                component::Color> boid(
+        component::WallAvoidance(30.0f),
+        component::ObstacleAvoidance(6.0f, 30.0f),
+        component::Separation(20.0f),
+        component::Alignment(50.0f),
+        component::Cohesion(50.0f),
+        component::Triangle(6.0f), // radius
+        component::Transform(
+            glm::vec2(0.0f, 0.0f),  // position
+            glm::vec2(0.0f, -1.0f), // rotation (head)
+            glm::vec2(0.75f, 1.0f)  // scale
+        ),
+        component::Move(
+            glm::vec2(0.0f, 0.0f), // velocity
+              1.0f, // mass
+            120.0f, // max speed
+             60.0f  // max force
+        ),
+        component::SteeringForce(),
+        component::Color(96, 96, 96, 255)
+    );
+    auto flock = boid.Instantiate(scene_, FLOCK_SIZE);
+    for (auto id : flock) {
+        auto angle = unit(engine) * 2.0f * glm::pi<float>();
+        auto head = glm::vec2(glm::cos(angle), glm::sin(angle));
+        auto t = scene_.GetComponent<component::Transform>(id);
+        t->position = glm::vec2(unit(engine) * SCREEN_W, unit(engine) * SCREEN_H);
+        t->rotation = head;
+        scene_.GetComponent<component::Move>(id)->velocity = head * 80.0f;
+    }
+
+    auto crosshair = scene_.NewEntity();
+    scene_.AddComponent<component::Crosshair>(
+        crosshair,
+        5.0f
+    );
+    scene_.AddComponent<component::Transform>(
+        crosshair,
+        glm::vec2(250.0f, 250.0f),
+        glm::vec2(0.0f, -1.0f),
+        glm::vec2(1.0f, 1.0f)
+    );
+    scene_.AddComponent<component::Color>(crosshair, 0, 0, 0, 255);
+
+    scheduler_.SetProfiler(&profiler_);
+    Schedule();
+}
+
+void Simulation::Step(float dt) {
+    Profiler::Scope scope(&profiler_, "Simulation::Step");
+    dt_ = dt;
+    scene_.NextTick();
+    scheduler_.Run();
+    steps_++;
+}
+
+bool Simulation::Save(const std::string &path) const {
+    return SceneCheckpoint::Save(scene_, path);
+}
+
+bool Simulation::Load(const std::string &path) {
+    return SceneCheckpoint::Load(scene_, path);
+}
+
+void Simulation::Schedule() {
+    using namespace component;
+
+    // Publish the state at the start of the tick, for the behaviors reading other agents
+    scheduler_.Add("ecs::Scene::SwapBuffers", Reads<Transform, Move>(), Writes<Front<Transform>, Front<Move>>(), [this]() {
+        scene_.SwapBuffers();
+    });
+    scheduler_.Add("update::Crosshair", Reads<Crosshair>(), Writes<Transform>(), [this]() {
+        update::Crosshair(target_, scene_);
+    });
+    scheduler_.Add("update::Wraparound", Reads<>(), Writes<Transform>(), [this]() {
+        update::Wraparound(SCREEN_W, SCREEN_H, scene_);
+    });
+    scheduler_.Add("spatial::Grid", Reads<Transform, Move>(), Writes<spatial::Grid>(), [this]() {
+        grid_.Build(scene_);
+    });
+
+    // Agents far from what they steer to are updated every few ticks, and
+    // the settled ones are held: those steering only from their own state,
+    // the target and the obstacles, when none of them changed since the
+    // previous tick
+    scheduler_.Add("lod::Schedule", Reads<Front<Transform>, Pursuit, Evade, Wander, Separation, Alignment, Cohesion, Transform, Move>(), Writes<SteeringForce>(), [this]() {
+        auto retarget = target_ != scheduled_;
+        scheduled_ = target_;
+        auto tick = scene_.GetTick();
+        auto transforms = scene_.GetPool(ecs::Component::GetId<component::Transform>());
+        auto moves = scene_.GetPool(ecs::Component::GetId<component::Move>());
+        auto held = [&](ecs::Entity::Id id) {
+            auto index = ecs::Entity::GetIndex(id);
+            return !retarget &&
+                   scene_.HasComponent<component::Move>(id) &&
+                   transforms->ChangedAt(index) + 1 < tick &&
+                   moves->ChangedAt(index) + 1 < tick &&
+                   !scene_.HasComponent<component::Pursuit>(id) &&
+                   !scene_.HasComponent<component::Evade>(id) &&
+                   !scene_.HasComponent<component::Wander>(id) &&
+                   !scene_.HasComponent<component::Separation>(id) &&
+                   !scene_.HasComponent<component::Alignment>(id) &&
+                   !scene_.HasComponent<component::Cohesion>(id);
+        };
+        lod::Schedule(lod_, [this](ecs::Entity::Id id, const component::Transform &t) {
+            auto focus = target_;
+            if (scene_.HasComponent<component::Pursuit>(id)) {
+                auto evader = scene_.GetFrontComponent<component::Transform>(
+                    scene_.GetComponent<component::Pursuit>(id)->evaderId);
+                if (evader != nullptr) {
+                    focus = evader->position;
+                }
+            }
+            return glm::length(focus - t.position);
+        }, held, scene_, &pool_);
+    });
+
+    // Behaviors by priority, the first ones get the steering force budget
+    scheduler_.Add("behavior::WallAvoidance", Reads<WallAvoidance, Transform, Move>(), Writes<SteeringForce>(), [this]() {
+        behavior::WallAvoidance(obstacles_, scene_, &pool_);
+    });
+    scheduler_.Add("behavior::ObstacleAvoidance", Reads<ObstacleAvoidance, Transform, Move>(), Writes<SteeringForce>(), [this]() {
+        behavior::ObstacleAvoidance(obstacles_, scene_, &pool_);
+    });
+    scheduler_.Add("behavior::Evade", Reads<Front<Transform>, Front<Move>, Evade, Transform, Move>(), Writes<SteeringForce>(), [this]() {
+        behavior::Evade(scene_, &pool_);
+    });
+    scheduler_.Add("behavior::Flee", Reads<Flee, Transform, Move>(), Writes<SteeringForce>(), [this]() {
+        behavior::Flee(target_, scene_, &pool_);
+    });
+    scheduler_.Add("behavior::Separation", Reads<spatial::Grid, Separation, Transform, Move>(), Writes<SteeringForce>(), [this]() {
+        behavior::Separation(grid_, scene_, &pool_);
+    });
+    scheduler_.Add("behavior::Seek", Reads<Seek, Transform, Move>(), Writes<SteeringForce>(), [this]() {
+        behavior::Seek(target_, scene_, &pool_);
+    });
+    scheduler_.Add("behavior::Arrive", Reads<Arrive, Transform, Move>(), Writes<SteeringForce>(), [this]() {
+        behavior::Arrive(target_, scene_, &pool_, &commands_);
+    });
+    scheduler_.Add("behavior::Pursuit", Reads<Front<Transform>, Front<Move>, Pursuit, Transform, Move>(), Writes<SteeringForce>(), [this]() {
+        behavior::Pursuit(scene_, &pool_);
+    });
+    scheduler_.Add("behavior::Alignment", Reads<spatial::Grid, Alignment, Transform, Move>(), Writes<SteeringForce>(), [this]() {
+        behavior::Alignment(grid_, scene_, &pool_);
+    });
+    scheduler_.Add("behavior::Cohesion", Reads<spatial::Grid, Cohesion, Transform, Move>(), Writes<SteeringForce>(), [this]() {
+        behavior::Cohesion(grid_, scene_, &pool_);
+    });
+    // Wander also moves its target and forward circles
+    scheduler_.Add("behavior::Wander", Reads<Move>(), Writes<Wander, Transform, Circle, SteeringForce>(), [this]() {
+        behavior::Wander(scene_, dt_, &pool_);
+    });
+
+    scheduler_.Add("update::Integrate", Reads<>(), Writes<Transform, Move, SteeringForce>(), [this]() {
+        update::Integrate(scene_, dt_, &pool_);
+    });
+
+    // Structural changes recorded by the systems
+    scheduler_.Add("ecs::CommandQueue::Playback", Reads<>(), Writes<ecs::Scene>(), [this]() {
+        commands_.Playback(scene_);
+    });
+
+    // A tick is numbered by the steps before it
+    scheduler_.Add("Telemetry::Record", Reads<Transform, Move>(), Writes<Telemetry>(), [this]() {
+        if (telemetry_ != nullptr) {
+            telemetry_->Record(scene_, steps_);
+        }
+    });
+}
+
+}  // steering
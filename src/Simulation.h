@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <glm/glm.hpp>
+
+#include <ECS.h>
+
+#include "Lod.h"
+#include "Obstacles.h"
+#include "Profiler.h"
+#include "Scheduler.h"
+#include "Spatial.h"
+#include "Telemetry.h"
+#include "ThreadPool.h"
+
+namespace steering {
+
+constexpr unsigned int SCREEN_W(1440);
+constexpr unsigned int SCREEN_H(1440);
+constexpr unsigned int FLOCK_SIZE(100);
+
+// Simulation time step, in seconds
+constexpr float FIXED_DT(1.0f / 60.0f);
+
+/**
+ * Simulation owns the scene and runs the update and behavior systems, without
+ * a window or a renderer. Game drives it in real time; it can also be stepped
+ * as fast as possible, e.g. for offline runs.
+ */
+class Simulation {
+public:
+    Simulation() {};
+
+    /**
+     * Create the agents and schedule the systems.
+     */
+    void Init();
+
+    /**
+     * Run every system once, advancing the simulation by dt seconds.
+     */
+    void Step(float dt);
+
+    /**
+     * Write the agents to a checkpoint file. Returns false if it can't be
+     * written.
+     */
+    bool Save(const std::string &path) const;
+
+    /**
+     * Replace the agents with the ones of a checkpoint file, after Init.
+     * Returns false, keeping the agents, if the file can't be read.
+     */
+    bool Load(const std::string &path);
+
+    /**
+     * Set the target of the crosshair and the Seek, Flee and Arrive behaviors.
+     */
+    void SetTarget(glm::vec2 target) {
+        target_ = target;
+    }
+
+    ecs::Scene &GetScene() {
+        return scene_;
+    }
+
+    /**
+     * Get the static obstacles and walls the flock avoids.
+     */
+    const spatial::Obstacles &GetObstacles() const {
+        return obstacles_;
+    }
+
+    /**
+     * Get the grid of the agents, as built by the last step.
+     */
+    const spatial::Grid &GetGrid() const {
+        return grid_;
+    }
+
+    uint64_t GetSteps() const {
+        return steps_;
+    }
+
+    /**
+     * Export the agents after every step to a telemetry exporter, or stop
+     * with nullptr. The exporter must outlive the simulation or be unset.
+     */
+    void SetTelemetry(Telemetry *telemetry) {
+        telemetry_ = telemetry;
+    }
+
+    /**
+     * Set the update periods of the agents' steering by their distance to
+     * the target, or to the evader for a pursuer. The default config
+     * updates every agent every tick.
+     */
+    void SetLod(const lod::Config &config) {
+        lod_ = config;
+    }
+
+    /**
+     * Get the profiler timing every system. Call EndFrame on it once per
+     * frame, between steps.
+     */
+    Profiler &GetProfiler() {
+        return profiler_;
+    }
+
+private:
+    void Schedule();
+
+    ecs::Scene scene_;
+    spatial::Grid grid_{ glm::vec2(SCREEN_W, SCREEN_H), 50.0f };
+    spatial::Obstacles obstacles_{};
+
+    Profiler profiler_{};
+    ecs::CommandQueue commands_{};
+    ThreadPool pool_{};
+    Telemetry *telemetry_{ nullptr };
+    lod::Config      lod_{};
+    Scheduler scheduler_{ pool_ };
+    float dt_{ 0.0f };
+
+    glm::vec2 target_{ SCREEN_W / 2, SCREEN_H / 2 };
+    glm::vec2 scheduled_{ target_ }; // target at the last lod::Schedule
+    uint64_t   steps_{ 0 };
+};
+
+}  // namespace steering
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <ECS.h>
+
+#include "Component.h"
+
+namespace steering {
+namespace spatial {
+/**
+ * Entry holds the state of an agent copied into the grid, so that neighbor
+ * queries don't need to look up components.
+ */
+struct Entry {
+    ecs::Entity::Id id;
+    glm::vec2 position;
+    glm::vec2 heading;
+    glm::vec2 velocity;
+};
+
+/**
+ * Grid is a uniform grid over the toroidal world defined by
+ * update::Wraparound. Entries are stored sorted by cell, so the entries of a
+ * cell are one contiguous span. The grid is rebuilt every tick with a
+ * counting sort that reuses its buffers, and queries never allocate.
+ */
+class Grid {
+public:
+    /**
+     * Constructor.
+     * The world is [0, size.x] x [0, size.y], wrapping around at the edges.
+     * The cell size is adjusted so that the cells tile the world exactly.
+     */
+    Grid(glm::vec2 size, float cellSize) : size_(size) {
+        cols_ = glm::max(1, static_cast<int>(size.x / cellSize + 0.5f));
+        rows_ = glm::max(1, static_cast<int>(size.y / cellSize + 0.5f));
+        cell_ = size / glm::vec2(static_cast<float>(cols_), static_cast<float>(rows_));
+        starts_.resize(cols_ * rows_ + 1);
+    }
+
+    /**
+     * Rebuild the grid from the entities having the Transform and Move
+     * components plus any additional component types.
+     */
+    template<class... ComponentTypes>
+    void Build(ecs::Scene &scene) {
+        entries_.clear();
+        cells_.clear();
+        std::fill(starts_.begin(), starts_.end(), 0);
+
+        ecs::SceneView<component::Transform,
+                       component::Move,
+                       ComponentTypes...>(scene).Each([&](
+                ecs::Entity::Id id,
+                component::Transform &t,
+                component::Move      &m,
+                ComponentTypes &...) {
+            auto cell = CellOf(t.position);
+            cells_.push_back(cell);
+            entries_.push_back(Entry{ id, t.position, t.rotation, m.velocity });
+            starts_[cell + 1]++;
+        });
+
+        // Counting sort of the entries by cell
+        for (size_t c = 1; c < starts_.size(); c++) {
+            starts_[c] += starts_[c - 1];
+        }
+        sorted_.resize(entries_.size());
+        cursor_.assign(starts_.begin(), starts_.end() - 1);
+        for (size_t i = 0; i < entries_.size(); i++) {
+            sorted_[cursor_[cells_[i]]++] = entries_[i];
+        }
+        entries_.swap(sorted_);
+    }
+
+    /**
+     * Visit the cells overlapping the circle around a position. The function
+     * is called as func(const Entry *first, const Entry *last) once per
+     * non-empty cell. The entries aren't filtered by distance; use Delta to
+     * measure it through the wraparound.
+     */
+    template<class Func>
+    void Query(glm::vec2 position, float radius, Func &&func) const {
+        QueryBox(position - radius, position + radius, std::forward<Func>(func));
+    }
+
+    /**
+     * Visit the cells overlapping a box, like Query. The box can extend past
+     * the edges of the world, whose cells are then visited through the
+     * wraparound.
+     */
+    template<class Func>
+    void QueryBox(glm::vec2 min, glm::vec2 max, Func &&func) const {
+        auto x0 = static_cast<int>(glm::floor(min.x / cell_.x));
+        auto x1 = static_cast<int>(glm::floor(max.x / cell_.x));
+        auto y0 = static_cast<int>(glm::floor(min.y / cell_.y));
+        auto y1 = static_cast<int>(glm::floor(max.y / cell_.y));
+        // Don't visit a cell twice when the box spans the whole world
+        x1 = glm::min(x1, x0 + cols_ - 1);
+        y1 = glm::min(y1, y0 + rows_ - 1);
+
+        for (auto y = y0; y <= y1; y++) {
+            auto row = Wrap(y, rows_) * cols_;
+            for (auto x = x0; x <= x1; x++) {
+                auto cell = row + Wrap(x, cols_);
+                auto first = entries_.data() + starts_[cell];
+                auto last  = entries_.data() + starts_[cell + 1];
+                if (first != last) {
+                    func(first, last);
+                }
+            }
+        }
+    }
+
+    /**
+     * Get the shortest vector from a to b through the wraparound.
+     */
+    glm::vec2 Delta(glm::vec2 a, glm::vec2 b) const {
+        auto d = b - a;
+        if (size_.x * 0.5f < d.x) {
+            d.x -= size_.x;
+        } else if (d.x < -size_.x * 0.5f) {
+            d.x += size_.x;
+        }
+        if (size_.y * 0.5f < d.y) {
+            d.y -= size_.y;
+        } else if (d.y < -size_.y * 0.5f) {
+            d.y += size_.y;
+        }
+        return d;
+    }
+
+    /**
+     * Get all entries, sorted by cell.
+     */
+    const std::vector<Entry> &GetEntries() const {
+        return entries_;
+    }
+
+private:
+    static int Wrap(int i, int n) {
+        i %= n;
+        return i < 0 ? i + n : i;
+    }
+
+    uint32_t CellOf(glm::vec2 position) const {
+        auto x = Wrap(static_cast<int>(glm::floor(position.x / cell_.x)), cols_);
+        auto y = Wrap(static_cast<int>(glm::floor(position.y / cell_.y)), rows_);
+        return static_cast<uint32_t>(y * cols_ + x);
+    }
+
+    glm::vec2 size_{ 0.0f };
+    glm::vec2 cell_{ 1.0f };
+    int cols_{ 1 };
+    int rows_{ 1 };
+
+    std::vector<Entry>     entries_{};
+    std::vector<Entry>      sorted_{};
+    std::vector<uint32_t>    cells_{};  // cell per unsorted entry
+    std::vector<uint32_t>   starts_{};  // first entry per cell, plus the end
+    std::vector<uint32_t>   cursor_{};
+};
+
+}  // spatial
+}  // steering
@@ -1,119 +1,207 @@
 #pragma once
 
-#include <random>
-
 #include <SDL.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
 
 #include <ECS.h>
 
+#include "Camera.h"
 #include "Component.h"
+#include "Integrator.h"
+#include "Lod.h"
+#include "Obstacles.h"
+#include "Parallel.h"
+#include "Profiler.h"
+#include "Random.h"
+#include "Render.h"
+#include "Spatial.h"
 #include "Transformation.h"
 
 namespace steering {
 
 namespace draw {
+// The draw functions add their shapes to a render::Batch, which is submitted
+// once per frame. They draw the agents at alpha between their state before
+// the last step, in the Transform front buffer, and the current one, through
+// a render::Camera, and skip the ones outside its viewport.
+
+// Longer moves in one step are jumps, e.g. through the wraparound
+constexpr float MAX_INTERPOLATION(100.0f);
+
+// Shapes smaller than this on the screen are drawn as points
+constexpr float MIN_PIXELS(1.0f);
+
+// Margin around the viewport when looking up the visible agents in the grid:
+// how far an agent can be drawn from its position in the grid, through its
+// radius and its move during the step
+constexpr float CULL_MARGIN(64.0f);
+
 /**
- * Draw triangles in an SDL rendering context.
+ * Interpolate the transform of an entity from its front buffer copy.
  */
-inline void Triangle(SDL_Renderer *renderer, ecs::Scene &scene) {
-    for (auto id : ecs::SceneView<component::Triangle,
-                                  component::Transform,
-                                  component::Color>(scene)) {
-        auto triangle = scene.GetComponent<component::Triangle>(id);
-        auto radius = triangle->radius;
-
-        auto transform = scene.GetComponent<component::Transform>(id);
-        auto   pos = transform->position;
-        auto  head = transform->rotation;
-        auto scale = transform->scale;
-        auto  side = glm::vec2(-head.y, head.x);
-
-        auto p1 = pos + head * radius * scale.y;
-        auto p2 = pos - head * radius + side * radius * scale.x;
-        auto p3 = pos - head * radius - side * radius * scale.x;
-
-        auto color = scene.GetComponent<component::Color>(id);
-        SDL_SetRenderDrawColor(renderer, color->r, color->g, color->b, color->a);
-        SDL_RenderDrawLine(renderer, p1.x, p1.y, p2.x, p2.y);
-        SDL_RenderDrawLine(renderer, p2.x, p2.y, p3.x, p3.y);
-        SDL_RenderDrawLine(renderer, p3.x, p3.y, p1.x, p1.y);
+inline component::Transform Interpolate(const ecs::Scene &scene, ecs::Entity::Id id,
+                                        const component::Transform &t, float alpha) {
+    auto previous = scene.GetFrontComponent<component::Transform>(id);
+    if (previous == nullptr || 1.0f <= alpha ||
+        MAX_INTERPOLATION < glm::length(t.position - previous->position)) {
+        return t;
     }
+    auto result = t;
+    result.position = glm::mix(previous->position, t.position, alpha);
+    auto rotation = glm::mix(previous->rotation, t.rotation, alpha);
+    if (glm::epsilon<float>() < glm::length(rotation)) {
+        result.rotation = glm::normalize(rotation);
+    }
+    return result;
 }
 
 /**
- * Draw crosshairs in an SDL rendering context.
+ * Add the outline of a triangle agent. An agent smaller than a pixel on the
+ * screen is drawn as a single point.
  */
-inline void Crosshair(SDL_Renderer *renderer, ecs::Scene &scene) {
-    for (auto id : ecs::SceneView<component::Crosshair,
-                                  component::Transform,
-                                  component::Color>(scene)) {
-        auto crosshair = scene.GetComponent<component::Crosshair>(id);
-        auto radius = crosshair->radius;
-
-        auto transform = scene.GetComponent<component::Transform>(id);
-        auto   pos = transform->position;
-        auto scale = transform->scale;
-
-        auto p1 = glm::vec2(pos.x + radius, pos.y) * scale;
-        auto p2 = glm::vec2(pos.x, pos.y + radius) * scale;
-        auto p3 = glm::vec2(pos.x - radius, pos.y) * scale;
-        auto p4 = glm::vec2(pos.x, pos.y - radius) * scale;
-
-        auto color = scene.GetComponent<component::Color>(id);
-        SDL_SetRenderDrawColor(renderer, color->r, color->g, color->b, color->a);
-        SDL_RenderDrawLine(renderer, p1.x, p1.y, p3.x, p3.y);
-        SDL_RenderDrawLine(renderer, p2.x, p2.y, p4.x, p4.y);
+inline void TriangleShape(render::Batch &batch, const render::Camera &camera,
+                          const component::Transform &transform, float radius,
+                          const component::Color &color) {
+    auto   pos = transform.position;
+    auto  head = transform.rotation;
+    auto scale = transform.scale;
+    auto  side = glm::vec2(-head.y, head.x);
+
+    if (radius * camera.zoom < MIN_PIXELS) {
+        batch.Point(camera.ToScreen(pos), color);
+        return;
     }
+    auto p1 = camera.ToScreen(pos + head * radius * scale.y);
+    auto p2 = camera.ToScreen(pos - head * radius + side * radius * scale.x);
+    auto p3 = camera.ToScreen(pos - head * radius - side * radius * scale.x);
+
+    batch.Line(p1, p2, color);
+    batch.Line(p2, p3, color);
+    batch.Line(p3, p1, color);
+}
+
+/**
+ * Draw triangles.
+ */
+inline void Triangle(render::Batch &batch, const render::Camera &camera,
+                     ecs::Scene &scene, float alpha = 1.0f) {
+    ecs::SceneView<component::Triangle,
+                   component::Transform,
+                   component::Color>(scene).Each([&](
+            ecs::Entity::Id id,
+            component::Triangle  &triangle,
+            component::Transform &current,
+            component::Color     &color) {
+        auto transform = Interpolate(scene, id, current, alpha);
+        if (camera.IsVisible(transform.position, triangle.radius)) {
+            TriangleShape(batch, camera, transform, triangle.radius, color);
+        }
+    });
 }
 
-inline void Circle(SDL_Renderer *renderer, ecs::Scene &scene) {
-    for (auto id : ecs::SceneView<component::Circle,
-                                  component::Transform,
-                                  component::Color>(scene)) {
-        auto circle = scene.GetComponent<component::Circle>(id);
-        auto radius = circle->radius;
-
-        auto transform = scene.GetComponent<component::Transform>(id);
-        auto   pos = transform->position;
-        auto scale = transform->scale;
-
-        auto color = scene.GetComponent<component::Color>(id);
-        SDL_SetRenderDrawColor(renderer, color->r, color->g, color->b, color->a);
-
-        // Based on x
-        for (auto x = -radius; x <= radius; x += 1.0f) {
-            auto y = glm::sqrt(radius * radius - x * x);
-            auto px = pos.x + x;
-            {
-                // Upper half
-                auto py = pos.y - y;
-                SDL_RenderDrawPoint(renderer, px, py);
+/**
+ * Draw the triangles of the agents in the grid cells overlapping the
+ * viewport, so that the cost depends on the visible agents rather than on
+ * all of them. Only the agents having a Move are in the grid. The grid must
+ * be built from the last step, and the agents created since then are only
+ * drawn after the next one.
+ */
+inline void Triangle(render::Batch &batch, const render::Camera &camera,
+                     const spatial::Grid &grid, ecs::Scene &scene, float alpha = 1.0f) {
+    grid.QueryBox(camera.Min() - CULL_MARGIN, camera.Max() + CULL_MARGIN, [&](
+            const spatial::Entry *first,
+            const spatial::Entry *last) {
+        for (auto e = first; e != last; e++) {
+            // The entry may have been removed by the end of the step
+            if (!scene.IsAlive(e->id) || !scene.HasComponent<component::Triangle>(e->id) ||
+                !scene.HasComponent<component::Color>(e->id)) {
+                continue;
             }
-            {
-                // Lower half
-                auto py = pos.y + y;
-                SDL_RenderDrawPoint(renderer, px, py);
+            auto radius = scene.GetComponent<component::Triangle>(e->id)->radius;
+            auto transform = Interpolate(scene, e->id, *scene.GetComponent<component::Transform>(e->id), alpha);
+            if (camera.IsVisible(transform.position, radius)) {
+                TriangleShape(batch, camera, transform, radius, *scene.GetComponent<component::Color>(e->id));
             }
         }
+    });
+}
 
-        // Based on y
-        for (auto y = -radius; y <= radius; y += 1.0f) {
-            auto x = glm::sqrt(radius * radius - y * y);
-            auto py = pos.y + y;
-            {
-                // Left half
-                auto px = pos.x - x;
-                SDL_RenderDrawPoint(renderer, px, py);
-            }
-            {
-                // Right half
-                auto px = pos.x + x;
-                SDL_RenderDrawPoint(renderer, px, py);
-            }
+/**
+ * Draw crosshairs.
+ */
+inline void Crosshair(render::Batch &batch, const render::Camera &camera,
+                      ecs::Scene &scene, float alpha = 1.0f) {
+    ecs::SceneView<component::Crosshair,
+                   component::Transform,
+                   component::Color>(scene).Each([&](
+            ecs::Entity::Id id,
+            component::Crosshair &crosshair,
+            component::Transform &current,
+            component::Color     &color) {
+        auto transform = Interpolate(scene, id, current, alpha);
+        auto radius = crosshair.radius;
+        if (!camera.IsVisible(transform.position, radius)) {
+            return;
         }
-    }
+
+        auto   pos = transform.position;
+        auto scale = transform.scale;
+
+        auto p1 = camera.ToScreen(glm::vec2(pos.x + radius, pos.y) * scale);
+        auto p2 = camera.ToScreen(glm::vec2(pos.x, pos.y + radius) * scale);
+        auto p3 = camera.ToScreen(glm::vec2(pos.x - radius, pos.y) * scale);
+        auto p4 = camera.ToScreen(glm::vec2(pos.x, pos.y - radius) * scale);
+
+        batch.Line(p1, p3, color);
+        batch.Line(p2, p4, color);
+    });
+}
+
+/**
+ * Draw circle outlines. A circle smaller than a pixel on the screen is
+ * drawn as a single point.
+ */
+inline void Circle(render::Batch &batch, const render::Camera &camera,
+                   ecs::Scene &scene, float alpha = 1.0f) {
+    ecs::SceneView<component::Circle,
+                   component::Transform,
+                   component::Color>(scene).Each([&](
+            ecs::Entity::Id id,
+            component::Circle    &circle,
+            component::Transform &current,
+            component::Color     &color) {
+        auto transform = Interpolate(scene, id, current, alpha);
+        if (!camera.IsVisible(transform.position, circle.radius)) {
+            return;
+        }
+        auto center = camera.ToScreen(transform.position);
+        if (circle.radius * camera.zoom < MIN_PIXELS) {
+            batch.Point(center, color);
+        } else {
+            batch.Circle(center, circle.radius * camera.zoom, color);
+        }
+    });
+}
+
+/**
+ * Draw the static obstacles and walls overlapping the viewport, looked up
+ * in their Bvh.
+ */
+inline void Obstacles(render::Batch &batch, const render::Camera &camera,
+                      const spatial::Obstacles &obstacles, const component::Color &color) {
+    spatial::Box view{ camera.Min(), camera.Max() };
+    obstacles.QueryObstacles(view, [&](const spatial::Obstacle &o) {
+        auto center = camera.ToScreen(o.position);
+        if (o.radius * camera.zoom < MIN_PIXELS) {
+            batch.Point(center, color);
+        } else {
+            batch.Circle(center, o.radius * camera.zoom, color);
+        }
+    });
+    obstacles.QueryWalls(view, [&](const spatial::Wall &w) {
+        batch.Line(camera.ToScreen(w.from), camera.ToScreen(w.to), color, 2.0f);
+    });
 }
 }  // draw
 
@@ -123,201 +211,267 @@ namespace update {
  * The new target position is provided as an argument to this function.
  */
 inline void Crosshair(glm::vec2 target, ecs::Scene &scene) {
-    for (auto id : ecs::SceneView<component::Crosshair,
-                                  component::Transform>(scene)) {
-        auto transform = scene.GetComponent<component::Transform>(id);
-        transform->position.x = target.x;
-        transform->position.y = target.y;
-    }
+    ecs::SceneView<component::Crosshair,
+                   component::Transform>(scene).Each([&](
+            ecs::Entity::Id       id,
+            component::Crosshair &,
+            component::Transform &transform) {
+        if (transform.position == target) {
+            return;
+        }
+        transform.position.x = target.x;
+        transform.position.y = target.y;
+        scene.MarkChanged<component::Transform>(id);
+    });
 }
 
 /**
  * Update the position for wraparound effect within
  * the boundaries of the screen width/height.
+ * When the Transform changes are tracked, only the entities that moved in
+ * the previous tick or this one are visited.
  */
 inline void Wraparound(int screenW, int screenH, ecs::Scene &scene) {
-    for (auto id : ecs::SceneView<component::Transform>(scene)) {
-        auto transform = scene.GetComponent<component::Transform>(id);
-
+    auto tick = scene.GetTick();
+    ecs::SceneView<component::Transform>(scene)
+        .ChangedSince<component::Transform>(tick == 0 ? 0 : tick - 1).Each([&](
+            ecs::Entity::Id       id,
+            component::Transform &transform) {
         auto maxX = static_cast<float>(screenW);
         auto maxY = static_cast<float>(screenH);
+        auto position = transform.position;
 
         // Wraparound X
-        if (maxX < transform->position.x) {
-            transform->position.x = 0.0f;
-        } else if (transform->position.x < 0.0f) {
-            transform->position.x = maxX;
+        if (maxX < transform.position.x) {
+            transform.position.x = 0.0f;
+        } else if (transform.position.x < 0.0f) {
+            transform.position.x = maxX;
         }
 
         // Wraparound Y
-        if (maxY < transform->position.y) {
-            transform->position.y = 0.0f;
-        } else if (transform->position.y < 0.0f) {
-            transform->position.y = maxY;
+        if (maxY < transform.position.y) {
+            transform.position.y = 0.0f;
+        } else if (transform.position.y < 0.0f) {
+            transform.position.y = maxY;
+        }
+
+        if (transform.position != position) {
+            scene.MarkChanged<component::Transform>(id);
+        }
+    });
+}
+
+/**
+ * Integrate the steering force accumulated by the behaviors once per agent,
+ * and clear the accumulator for the next tick. The agents updated less
+ * often, and the settled ones held by lod::Schedule, keep it until they are
+ * updated again. The agents that moved are marked as changed, and those
+ * whose velocity changed too, if the Transform and Move changes are tracked.
+ */
+inline void Integrate(ecs::Scene &scene, float dt, ThreadPool *pool = nullptr) {
+    auto transforms = scene.GetPool(ecs::Component::GetId<component::Transform>());
+    auto moves = scene.GetPool(ecs::Component::GetId<component::Move>());
+    auto ticks = transforms == nullptr ? nullptr : transforms->Ticks();
+    auto moveTicks = moves == nullptr ? nullptr : moves->Ticks();
+    auto tick = scene.GetTick();
+    auto integrate = [&](ecs::ChunkView<component::Transform,
+                                        component::Move,
+                                        component::SteeringForce>::Chunk chunk) {
+        auto sf = chunk.Get<component::SteeringForce>();
+        integrator::IntegrateRows(
+            chunk.Get<component::Transform>(),
+            chunk.Get<component::Move>(),
+            sf, chunk.Size(), dt,
+            ticks == nullptr ? nullptr : ticks + chunk.First(), tick,
+            moveTicks == nullptr ? nullptr : moveTicks + chunk.First()
+        );
+        for (uint64_t i = 0; i < chunk.Size(); i++) {
+            if (sf[i].period <= 1 && !sf[i].held) {
+                sf[i] = component::SteeringForce();
+            }
+        }
+    };
+
+    ecs::ChunkView<component::Transform,
+                   component::Move,
+                   component::SteeringForce> view(scene);
+    if (pool != nullptr) {
+        ParallelChunks(*pool, view, integrate);
+    } else {
+        for (auto chunk : view) {
+            integrate(chunk);
         }
     }
 }
 }  // update
 
 namespace behavior {
+// Behaviors only accumulate their weighted steering force into the agent's
+// SteeringForce, in the order they are called. Call them by priority, then
+// update::Integrate. Given a thread pool, a behavior runs in parallel over
+// its agents; it then writes only the agent it's given and reads the other
+// agents from the grid or through Peer. They only visit the agents selected
+// by lod::Schedule for the tick.
+
 /**
- * Seek behavior for entities.
+ * Read a component of another agent: its front buffer copy if the type is
+ * double buffered, so that the result doesn't depend on the update order,
+ * or else the live component, which the behaviors don't write. Returns
+ * nullptr if the agent doesn't have the component.
  */
-inline void Seek(glm::vec2 target, ecs::Scene &scene, float dt) {
-    for (auto id : ecs::SceneView<component::Seek,
-                                  component::Transform,
-                                  component::Move>(scene)) {
-        auto m = scene.GetComponent<component::Move>(id);
-        auto t = scene.GetComponent<component::Transform>(id);
+template<class T>
+inline const T *Peer(const ecs::Scene &scene, ecs::Entity::Id id) {
+    auto pool = scene.GetPool(ecs::Component::GetId<T>());
+    if (pool == nullptr || !scene.IsAlive(id)) {
+        return nullptr;
+    }
+    if (pool->IsDoubleBuffered()) {
+        return scene.GetFrontComponent<T>(id);
+    }
+    auto i = ecs::Entity::GetIndex(id);
+    return pool->Has(i) ? static_cast<const T *>(pool->Get(i)) : nullptr;
+}
 
+/**
+ * Seek behavior for entities.
+ */
+inline void Seek(glm::vec2 target, ecs::Scene &scene, ThreadPool *pool = nullptr) {
+    Each(pool, lod::Due<component::Seek,
+                        component::Transform,
+                        component::Move,
+                        component::SteeringForce>(scene), [&](
+            component::Seek          &s,
+            component::Transform     &t,
+            component::Move          &m,
+            component::SteeringForce &sf) {
         // Calculate the direction and distance to the target.
-        auto direct = target - t->position;
+        auto direct = target - t.position;
         auto dist = glm::length(direct);
         if (dist < glm::epsilon<float>()) {
-            continue;
+            return;
         }
         direct /= dist;
 
         // Compute the desired velocity and steering force.
-        auto velocity = direct * m->maxSpeed;
-        auto steering = velocity - m->velocity;
-
-        // Limit the steering force to the maximum allowed force.
-        // This help to create smooth movement, preventing the entity from
-        // instantly turning around to face the target.
-        auto lenS = glm::length(steering);
-        if (m->maxForce < lenS) {
-            steering /= lenS;
-            steering *= m->maxForce;
-        }
-
-        // Calculate acceleration based on the steering force.
-        auto acc = steering / m->mass;
-        m->velocity += acc * dt;
-
-        // Limit the entity's speed to its maxmum speed.
-        auto lenV1 = glm::length(m->velocity);
-        if (m->maxSpeed < lenV1) {
-            m->velocity /= lenV1;
-            m->velocity *= m->maxSpeed;
-        }
-
-        // Update the entity's position.
-        t->position += m->velocity * dt;
+        auto velocity = direct * m.maxSpeed;
+        auto steering = velocity - m.velocity;
 
-        // If the entity is stationary, skip the rotation step.
-        auto lenV2 = glm::length(m->velocity);
-        if (lenV2 < glm::epsilon<float>()) {
-            return;
-        }
-        t->rotation = glm::normalize(m->velocity);
-    }
+        integrator::Accumulate(sf, steering, s.weight, m.maxForce);
+    });
 }
 
 /**
  * Flee behavior for entities.
  */
-inline void Flee(glm::vec2 target, ecs::Scene &scene, float dt) {
-    for (auto id : ecs::SceneView<component::Flee,
-                                  component::Transform,
-                                  component::Move>(scene)) {
-        auto f = scene.GetComponent<component::Flee>(id);
-        auto m = scene.GetComponent<component::Move>(id);
-        auto t = scene.GetComponent<component::Transform>(id);
-
-        auto direct = t->position - target;  // Flee direction from the target
+inline void Flee(glm::vec2 target, ecs::Scene &scene, ThreadPool *pool = nullptr) {
+    Each(pool, lod::Due<component::Flee,
+                        component::Transform,
+                        component::Move,
+                        component::SteeringForce>(scene), [&](
+            component::Flee          &f,
+            component::Transform     &t,
+            component::Move          &m,
+            component::SteeringForce &sf) {
+        auto direct = t.position - target;  // Flee direction from the target
         auto dist = glm::length(direct);
         if (dist < glm::epsilon<float>()) {
-            continue;
+            return;
         }
         direct /= dist;
 
-        auto velocity = direct * m->maxSpeed;
-        auto steering = velocity - m->velocity;
-
-        auto lenS = glm::length(steering);
-        if (m->maxForce < lenS) {
-            steering /= lenS;
-            steering *= m->maxForce;
-        }
-
-        // Zero steering force if the target isn't in the escape radius
-        if (f->radius < dist) {
-            steering = glm::vec2(0.0f);
-        }
-        auto acc = steering / m->mass;
-        m->velocity += acc * dt;
+        auto velocity = direct * m.maxSpeed;
+        auto steering = velocity - m.velocity;
 
-        auto lenV1 = glm::length(m->velocity);
-        if (m->maxSpeed < lenV1) {
-            m->velocity /= lenV1;
-            m->velocity *= m->maxSpeed;
+        // No steering force if the target isn't in the escape radius
+        if (f.radius < dist) {
+            return;
         }
+        integrator::Accumulate(sf, steering, f.weight, m.maxForce);
+    });
+}
 
-        t->position += m->velocity * dt;
+/**
+ * Obstacle avoidance behavior for entities.
+ * Steers around the closest static obstacle ahead, see spatial::AvoidObstacles.
+ */
+inline void ObstacleAvoidance(const spatial::Obstacles &obstacles, ecs::Scene &scene,
+                              ThreadPool *pool = nullptr) {
+    Each(pool, lod::Due<component::ObstacleAvoidance,
+                        component::Transform,
+                        component::Move,
+                        component::SteeringForce>(scene), [&](
+            component::ObstacleAvoidance &oa,
+            component::Transform         &t,
+            component::Move              &m,
+            component::SteeringForce     &sf) {
+        auto steering = spatial::AvoidObstacles(obstacles, t, m, oa);
+        integrator::Accumulate(sf, steering, oa.weight, m.maxForce);
+    });
+}
 
-        auto lenV2 = glm::length(m->velocity);
-        if (lenV2 < glm::epsilon<float>()) {
-            return;
-        }
-        t->rotation = glm::normalize(m->velocity);
-    }
+/**
+ * Wall avoidance behavior for entities.
+ * Steers away from the static walls its feelers cross, see spatial::AvoidWalls.
+ */
+inline void WallAvoidance(const spatial::Obstacles &obstacles, ecs::Scene &scene,
+                          ThreadPool *pool = nullptr) {
+    Each(pool, lod::Due<component::WallAvoidance,
+                        component::Transform,
+                        component::Move,
+                        component::SteeringForce>(scene), [&](
+            component::WallAvoidance &wa,
+            component::Transform     &t,
+            component::Move          &m,
+            component::SteeringForce &sf) {
+        auto steering = spatial::AvoidWalls(obstacles, t, m, wa);
+        integrator::Accumulate(sf, steering, wa.weight, m.maxForce);
+    });
 }
 
 /**
  * Arrive behavior for entities.
  */
-inline void Arrive(glm::vec2 target, ecs::Scene &scene, float dt) {
-    for (auto id : ecs::SceneView<component::Arrive,
-                                  component::Transform,
-                                  component::Move>(scene)) {
-        auto a = scene.GetComponent<component::Arrive>(id);
-        auto m = scene.GetComponent<component::Move>(id);
-        auto t = scene.GetComponent<component::Transform>(id);
-
-        auto direct = target - t->position;
+inline void Arrive(glm::vec2 target, ecs::Scene &scene, ThreadPool *pool = nullptr,
+                   ecs::CommandQueue *commands = nullptr) {
+    Each(pool, lod::Due<component::Arrive,
+                        component::Transform,
+                        component::Move,
+                        component::SteeringForce>(scene), [&](
+            ecs::Entity::Id id,
+            component::Arrive        &a,
+            component::Transform     &t,
+            component::Move          &m,
+            component::SteeringForce &sf) {
+        auto direct = target - t.position;
         auto dist = glm::length(direct);
 
+        // The scene can't change while it's iterated, remove the agent later
+        if (commands != nullptr && dist < a.despawn) {
+            commands->Local().Despawn(id);
+            return;
+        }
+
         auto steering = glm::zero<glm::vec2>();
         if (glm::epsilon<float>() < dist) {
-            auto speed = static_cast<float>(dist / (a->deceleration));
-            speed = glm::min<float>(speed, m->maxSpeed);
+            auto speed = static_cast<float>(dist / (a.deceleration));
+            speed = glm::min<float>(speed, m.maxSpeed);
 
             auto velocity = direct * speed / dist;
-            steering = velocity - m->velocity;
-        }
-
-        auto lenS = glm::length(steering);
-        if (m->maxForce < lenS) {
-            steering /= lenS;
-            steering *= m->maxForce;
-        }
-
-        auto acc = steering / m->mass;
-        m->velocity += acc * dt;
-
-        auto lenV1 = glm::length(m->velocity);
-        if (m->maxSpeed < lenV1) {
-            m->velocity /= lenV1;
-            m->velocity *= m->maxSpeed;
+            steering = velocity - m.velocity;
         }
 
-        auto lenV2 = glm::length(m->velocity);
-        if (lenV2 < 10.0f) {
-            // No need to adjust position or rotation if the agent is within
-            // a certain proximity to the target.
-            return;
-        }
-        t->position += m->velocity * dt;
-        t->rotation = glm::normalize(m->velocity);
-    }
+        // No need to adjust position or rotation if the agent is within
+        // a certain proximity to the target.
+        sf.rest = glm::max(sf.rest, 10.0f);
+        integrator::Accumulate(sf, steering, a.weight, m.maxForce);
+    });
 }
 
 /**
  * Calculate the time an agent requires to reorient itself towards a target.
  */
-inline float TurnaroundTime(component::Transform *pTransform,
-                            component::Transform *eTransform) {
+inline float TurnaroundTime(const component::Transform *pTransform,
+                            const component::Transform *eTransform) {
     auto to = glm::normalize(eTransform->position - pTransform->position);
     auto dot = glm::dot(pTransform->rotation, to);
 
@@ -328,26 +482,26 @@ inline float TurnaroundTime(component::Transform *pTransform,
 /**
  * Pursuit behavior for entities.
  */
-inline void Pursuit(ecs::Scene &scene, float dt) {
-    for (auto id : ecs::SceneView<component::Pursuit,
-                                  component::Transform,
-                                  component::Move>(scene)) {
-        auto p = scene.GetComponent<component::Pursuit>(id);
-        auto t = scene.GetComponent<component::Transform>(id);
-        auto m = scene.GetComponent<component::Move>(id);
-
-        if (!ecs::Entity::IsValid(p->evaderId)) {
-            continue;
+inline void Pursuit(ecs::Scene &scene, ThreadPool *pool = nullptr) {
+    Each(pool, lod::Due<component::Pursuit,
+                        component::Transform,
+                        component::Move,
+                        component::SteeringForce>(scene), [&](
+            component::Pursuit       &p,
+            component::Transform     &t,
+            component::Move          &m,
+            component::SteeringForce &sf) {
+        if (!ecs::Entity::IsValid(p.evaderId)) {
+            return;
         }
-        if (!scene.HasComponent<component::Transform>(p->evaderId) ||
-            !scene.HasComponent<component::Move>(p->evaderId)) {
-            continue;
+        auto et = Peer<component::Transform>(scene, p.evaderId);
+        auto em = Peer<component::Move>(scene, p.evaderId);
+        if (et == nullptr || em == nullptr) {
+            return;
         }
-        auto et = scene.GetComponent<component::Transform>(p->evaderId);
-        auto em = scene.GetComponent<component::Move>(p->evaderId);
 
-        auto to = et->position - t->position;
-        auto dot = glm::dot(t->rotation, et->rotation);
+        auto to = et->position - t.position;
+        auto dot = glm::dot(t.rotation, et->rotation);
 
         // Init the target with the evader's position
         auto target = et->position;
@@ -359,194 +513,240 @@ inline void Pursuit(ecs::Scene &scene, float dt) {
         // How long the pursuer can predict the evader's future position
         // is proportional to the distance between them and
         // inversaly proportional to the sum of their speeds.
-        auto angle = glm::acos(dot) * 180 / glm::pi<float>();
-        auto dot2 = glm::dot(t->rotation, to);
+        auto dot2 = glm::dot(t.rotation, to);
         if ((dot2 < 0) || dot < 0.95) {
-            SDL_Log("Pursuit: By Predict: dot2 %f", dot2);
-            SDL_Log("Pursuit: By Predict: angle %f", angle);
-            auto lookaheadtime = glm::length(to) / (m->maxSpeed + em->maxSpeed);
-            lookaheadtime += TurnaroundTime(t, et);
+            STEERING_TRACE_LOG("Pursuit: By Predict: dot2 %f", dot2);
+            STEERING_TRACE_LOG("Pursuit: By Predict: angle %f", glm::acos(dot) * 180 / glm::pi<float>());
+            auto lookaheadtime = glm::length(to) / (m.maxSpeed + em->maxSpeed);
+            lookaheadtime += TurnaroundTime(&t, et);
             target = et->position + em->velocity * lookaheadtime;
         } else {
-            SDL_Log("Pursuit: By Seek: dot2 %f", dot2);
-            SDL_Log("Pursuit: By Seek: angle: %f", angle);
+            STEERING_TRACE_LOG("Pursuit: By Seek: dot2 %f", dot2);
+            STEERING_TRACE_LOG("Pursuit: By Seek: angle: %f", glm::acos(dot) * 180 / glm::pi<float>());
         }
 
-        // TODO: Computing below is the same as the seek, so should be replaced
-        //       to a new common function.
-        auto direct = target - t->position;
+        auto direct = target - t.position;
         auto dist = glm::length(direct);
         if (dist < glm::epsilon<float>()) {
-            continue;
+            return;
         }
         direct /= dist;
 
-        auto velocity = direct * m->maxSpeed;
-        auto steering = velocity - m->velocity;
-
-        auto lenS = glm::length(steering);
-        if (m->maxForce < lenS) {
-            steering /= lenS;
-            steering *= m->maxForce;
-        }
-
-        auto acc = steering / m->mass;
-        m->velocity += acc * dt;
-
-        auto lenV1 = glm::length(m->velocity);
-        if (m->maxSpeed < lenV1) {
-            m->velocity /= lenV1;
-            m->velocity *= m->maxSpeed;
-        }
+        auto velocity = direct * m.maxSpeed;
+        auto steering = velocity - m.velocity;
 
-        t->position += m->velocity * dt;
-
-        auto lenV2 = glm::length(m->velocity);
-        if (lenV2 < glm::epsilon<float>()) {
-            return;
-        }
-        t->rotation = glm::normalize(m->velocity);
-    }
+        integrator::Accumulate(sf, steering, p.weight, m.maxForce);
+    });
 }
 
 /**
  * Evade behavior for entities.
  */
-inline void Evade(ecs::Scene &scene, float dt) {
-    for (auto id : ecs::SceneView<component::Evade,
-                                  component::Transform,
-                                  component::Move>(scene)) {
-        auto e = scene.GetComponent<component::Evade>(id);
-        auto t = scene.GetComponent<component::Transform>(id);
-        auto m = scene.GetComponent<component::Move>(id);
-
-        if (!ecs::Entity::IsValid(e->pursuerId)) {
-            continue;
+inline void Evade(ecs::Scene &scene, ThreadPool *pool = nullptr) {
+    Each(pool, lod::Due<component::Evade,
+                        component::Transform,
+                        component::Move,
+                        component::SteeringForce>(scene), [&](
+            component::Evade         &e,
+            component::Transform     &t,
+            component::Move          &m,
+            component::SteeringForce &sf) {
+        if (!ecs::Entity::IsValid(e.pursuerId)) {
+            return;
         }
-        if (!scene.HasComponent<component::Transform>(e->pursuerId) ||
-            !scene.HasComponent<component::Move>(e->pursuerId)) {
-            continue;
+        auto pt = Peer<component::Transform>(scene, e.pursuerId);
+        auto pm = Peer<component::Move>(scene, e.pursuerId);
+        if (pt == nullptr || pm == nullptr) {
+            return;
         }
-        auto pt = scene.GetComponent<component::Transform>(e->pursuerId);
-        auto pm = scene.GetComponent<component::Move>(e->pursuerId);
 
-        auto to = pt->position - t->position;
-        auto lookaheadtime = glm::length(to) / (m->maxSpeed + pm->maxSpeed);
+        auto to = pt->position - t.position;
+        auto lookaheadtime = glm::length(to) / (m.maxSpeed + pm->maxSpeed);
         auto target = pt->position + pm->velocity * lookaheadtime;
 
-        // TODO: The same process of Flee
-        auto direct = t->position - target;  // Flee direction from the target
+        auto direct = t.position - target;  // Flee direction from the target
         auto dist = glm::length(direct);
         if (dist < glm::epsilon<float>()) {
-            continue;
+            return;
         }
         direct /= dist;
 
-        auto velocity = direct * m->maxSpeed;
-        auto steering = velocity - m->velocity;
-
-        auto lenS = glm::length(steering);
-        if (m->maxForce < lenS) {
-            steering /= lenS;
-            steering *= m->maxForce;
-        }
-
-        // Zero steering force if the target isn't in the escape radius
-        if (e->radius < dist) {
-            steering = glm::vec2(0.0f);
-        }
-        auto acc = steering / m->mass;
-        m->velocity += acc * dt;
+        auto velocity = direct * m.maxSpeed;
+        auto steering = velocity - m.velocity;
 
-        auto lenV1 = glm::length(m->velocity);
-        if (m->maxSpeed < lenV1) {
-            m->velocity /= lenV1;
-            m->velocity *= m->maxSpeed;
+        // No steering force if the target isn't in the escape radius
+        if (e.radius < dist) {
+            return;
         }
+        integrator::Accumulate(sf, steering, e.weight, m.maxForce);
+    });
+}
 
-        t->position += m->velocity * dt;
+/**
+ * Separation behavior for entities.
+ * Steers away from the neighbors within the radius, harder the closer they are.
+ */
+inline void Separation(const spatial::Grid &grid, ecs::Scene &scene,
+                       ThreadPool *pool = nullptr) {
+    Each(pool, lod::Due<component::Separation,
+                        component::Transform,
+                        component::Move,
+                        component::SteeringForce>(scene), [&](
+            ecs::Entity::Id id,
+            component::Separation    &s,
+            component::Transform     &t,
+            component::Move          &m,
+            component::SteeringForce &sf) {
+        auto steering = glm::vec2(0.0f);
+        grid.Query(t.position, s.radius, [&](const spatial::Entry *first,
+                                             const spatial::Entry *last) {
+            for (auto n = first; n != last; n++) {
+                auto away = grid.Delta(n->position, t.position);
+                auto dist = glm::length(away);
+                if (n->id == id || dist < glm::epsilon<float>() || s.radius < dist) {
+                    continue;
+                }
+                steering += away / dist * (1.0f - dist / s.radius);
+            }
+        });
+        integrator::Accumulate(sf, steering * m.maxForce, s.weight, m.maxForce);
+    });
+}
 
-        auto lenV2 = glm::length(m->velocity);
-        if (lenV2 < glm::epsilon<float>()) {
+/**
+ * Alignment behavior for entities.
+ * Steers towards the average velocity of the neighbors within the radius.
+ */
+inline void Alignment(const spatial::Grid &grid, ecs::Scene &scene,
+                      ThreadPool *pool = nullptr) {
+    Each(pool, lod::Due<component::Alignment,
+                        component::Transform,
+                        component::Move,
+                        component::SteeringForce>(scene), [&](
+            ecs::Entity::Id id,
+            component::Alignment     &a,
+            component::Transform     &t,
+            component::Move          &m,
+            component::SteeringForce &sf) {
+        auto velocity = glm::vec2(0.0f);
+        auto count = 0;
+        grid.Query(t.position, a.radius, [&](const spatial::Entry *first,
+                                             const spatial::Entry *last) {
+            for (auto n = first; n != last; n++) {
+                if (n->id == id || a.radius < glm::length(grid.Delta(t.position, n->position))) {
+                    continue;
+                }
+                velocity += n->velocity;
+                count++;
+            }
+        });
+        if (count == 0) {
             return;
         }
-        t->rotation = glm::normalize(m->velocity);
-    }
+        auto steering = velocity / static_cast<float>(count) - m.velocity;
+        integrator::Accumulate(sf, steering, a.weight, m.maxForce);
+    });
 }
 
 /**
- *
+ * Cohesion behavior for entities.
+ * Seeks the center of mass of the neighbors within the radius.
  */
-inline float RandomClamped() {
-    static std::default_random_engine engine(std::random_device{}());
-    static std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
-    return dist(engine);
+inline void Cohesion(const spatial::Grid &grid, ecs::Scene &scene,
+                     ThreadPool *pool = nullptr) {
+    Each(pool, lod::Due<component::Cohesion,
+                        component::Transform,
+                        component::Move,
+                        component::SteeringForce>(scene), [&](
+            ecs::Entity::Id id,
+            component::Cohesion      &c,
+            component::Transform     &t,
+            component::Move          &m,
+            component::SteeringForce &sf) {
+        auto offset = glm::vec2(0.0f);
+        auto count = 0;
+        grid.Query(t.position, c.radius, [&](const spatial::Entry *first,
+                                             const spatial::Entry *last) {
+            for (auto n = first; n != last; n++) {
+                auto to = grid.Delta(t.position, n->position);
+                if (n->id == id || c.radius < glm::length(to)) {
+                    continue;
+                }
+                offset += to;
+                count++;
+            }
+        });
+        if (count == 0) {
+            return;
+        }
+
+        // Offset to the center of mass, through the wraparound
+        auto direct = offset / static_cast<float>(count);
+        auto dist = glm::length(direct);
+        if (dist < glm::epsilon<float>()) {
+            return;
+        }
+        direct /= dist;
+
+        auto velocity = direct * m.maxSpeed;
+        auto steering = velocity - m.velocity;
+        integrator::Accumulate(sf, steering, c.weight, m.maxForce);
+    });
 }
 
 /**
- * Wander behavior for entities.
+ * Wander behavior for entities. Every agent draws its jitter from its own
+ * random stream, so the result doesn't depend on the thread count. Given a
+ * thread pool, every agent must have its own target and forward circles.
  */
-inline void Wander(ecs::Scene &scene, float dt) {
-    for (auto id : ecs::SceneView<component::Wander,
-                                  component::Transform,
-                                  component::Move>(scene)) {
-        auto w = scene.GetComponent<component::Wander>(id);
-        auto t = scene.GetComponent<component::Transform>(id);
-        auto m = scene.GetComponent<component::Move>(id);
-
-        auto  targetCircle = w->target;
-        auto forwardCircle = w->forward;
+inline void Wander(ecs::Scene &scene, float dt, ThreadPool *pool = nullptr) {
+    Each(pool, lod::Due<component::Wander,
+                        component::Transform,
+                        component::Move,
+                        component::SteeringForce>(scene), [&](
+            ecs::Entity::Id           id,
+            component::Wander        &w,
+            component::Transform     &t,
+            component::Move          &m,
+            component::SteeringForce &sf) {
+        auto  targetCircle = w.target;
+        auto forwardCircle = w.forward;
 
         auto tt = scene.GetComponent<component::Transform>(targetCircle);
         auto ft = scene.GetComponent<component::Transform>(forwardCircle);
         auto fc = scene.GetComponent<component::Circle>(forwardCircle);
 
-        auto randomX = RandomClamped() * w->jitter * dt;
-        auto randomY = RandomClamped() * w->jitter * dt;
-        w->point += glm::vec2(randomX, randomY);
-        w->point  = glm::normalize(w->point);
-        w->point *= w->radius;
+        // An agent updated every few ticks jitters for all of them
+        auto step = dt * static_cast<float>(sf.period);
+        random::Stream stream{ random::Key(id, w.seed), w.counter };
+        auto randomX = stream.NextClamped() * w.jitter * step;
+        auto randomY = stream.NextClamped() * w.jitter * step;
+        w.counter = stream.counter;
+        w.point += glm::vec2(randomX, randomY);
+        w.point  = glm::normalize(w.point);
+        w.point *= w.radius;
 
-        auto targetLocal = w->point + glm::vec2(w->distance, 0);
-        auto targetWorld = ToWorld(targetLocal, t->position, t->rotation, glm::vec2(1.0f, 1.0f));
+        auto targetLocal = w.point + glm::vec2(w.distance, 0);
+        auto targetWorld = ToWorld(targetLocal, t.position, t.rotation, glm::vec2(1.0f, 1.0f));
 
-        auto direct = targetWorld - t->position;
+        auto direct = targetWorld - t.position;
         auto dist = glm::length(direct);
         if (dist < glm::epsilon<float>()) {
-            continue;
+            return;
         }
         direct /= dist;
 
-        auto velocity = direct * m->maxSpeed;
-        auto steering = velocity - m->velocity;
+        auto velocity = direct * m.maxSpeed;
+        auto steering = velocity - m.velocity;
 
-        auto lenS = glm::length(steering);
-        if (m->maxForce < lenS) {
-            steering /= lenS;
-            steering *= m->maxForce;
-        }
-
-        auto acc = steering / m->mass;
-        m->velocity += acc * dt;
-
-        auto lenV1 = glm::length(m->velocity);
-        if (m->maxSpeed < lenV1) {
-            m->velocity /= lenV1;
-            m->velocity *= m->maxSpeed;
-        }
-
-        t->position += m->velocity * dt;
+        integrator::Accumulate(sf, steering, w.weight, m.maxForce);
 
-        auto lenV2 = glm::length(m->velocity);
-        if (lenV2 < glm::epsilon<float>()) {
-            return;
-        }
-        t->rotation = glm::normalize(m->velocity);
-
-        fc->radius   = w->radius;
-        ft->position = t->position + t->rotation * w->distance;
+        fc->radius   = w.radius;
+        ft->position = t.position + t.rotation * w.distance;
         tt->position = targetWorld;
-    }
+        scene.MarkChanged<component::Transform>(forwardCircle);
+        scene.MarkChanged<component::Transform>(targetCircle);
+    });
 }
 
 }  // behavior
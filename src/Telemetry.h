@@ -0,0 +1,354 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ECS.h>
+
+#include "Component.h"
+
+namespace steering {
+namespace telemetry {
+
+constexpr uint32_t MAGIC(0x4d545453);  // "STTM"
+constexpr uint32_t VERSION(1);
+
+/**
+ * Frame holds the sampled columns of every agent having a Transform and a
+ * Move at one tick.
+ */
+struct Frame {
+    uint64_t                     tick{ 0 };
+    std::vector<ecs::Entity::Id>  ids{};
+    std::vector<float>             px{}, py{};  // position
+    std::vector<float>             vx{}, vy{};  // velocity
+
+    size_t Size() const {
+        return ids.size();
+    }
+};
+
+/**
+ * File header: the ID size is recorded, so that a file is only read by a
+ * build with the same ECS options.
+ */
+struct Header {
+    uint32_t   magic{ MAGIC };
+    uint32_t version{ VERSION };
+    uint32_t  idSize{ sizeof(ecs::Entity::Id) };
+    uint32_t columns{ 5 };
+};
+
+/**
+ * Header of the chunk of one frame, followed by its encoded columns.
+ */
+struct ChunkHeader {
+    uint64_t  tick{ 0 };
+    uint64_t count{ 0 };  // agents
+    uint64_t bytes{ 0 };  // encoded columns
+};
+
+// Columns are delta encoded against the same row of the previous frame:
+// IDs as zigzag differences, floats as the XOR of their bits, which has
+// few significant bits when the value barely changed. Every delta is then
+// written as a little-endian base-128 varint.
+
+inline void PutVarint(std::vector<uint8_t> &out, uint64_t value) {
+    while (0x80 <= value) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+/**
+ * Read a varint. Returns false if the input ends before it does.
+ */
+inline bool GetVarint(const uint8_t *&in, const uint8_t *end, uint64_t &value) {
+    value = 0;
+    for (uint32_t shift = 0; in < end && shift < 64; shift += 7) {
+        auto byte = *in++;
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline uint32_t Bits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline float Float(uint32_t bits) {
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+inline void PutIds(std::vector<uint8_t> &out, const std::vector<ecs::Entity::Id> &ids,
+                   const std::vector<ecs::Entity::Id> &previous) {
+    for (size_t i = 0; i < ids.size(); i++) {
+        auto delta = static_cast<int64_t>(ids[i] - (i < previous.size() ? previous[i] : 0));
+        PutVarint(out, static_cast<uint64_t>(delta << 1) ^ static_cast<uint64_t>(delta >> 63));
+    }
+}
+
+inline void PutFloats(std::vector<uint8_t> &out, const std::vector<float> &values,
+                      const std::vector<float> &previous) {
+    for (size_t i = 0; i < values.size(); i++) {
+        PutVarint(out, Bits(values[i]) ^ (i < previous.size() ? Bits(previous[i]) : 0u));
+    }
+}
+
+inline bool GetIds(const uint8_t *&in, const uint8_t *end, std::vector<ecs::Entity::Id> &ids,
+                   const std::vector<ecs::Entity::Id> &previous) {
+    for (size_t i = 0; i < ids.size(); i++) {
+        uint64_t zigzag;
+        if (!GetVarint(in, end, zigzag)) {
+            return false;
+        }
+        auto delta = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+        ids[i] = static_cast<ecs::Entity::Id>((i < previous.size() ? previous[i] : 0) + delta);
+    }
+    return true;
+}
+
+inline bool GetFloats(const uint8_t *&in, const uint8_t *end, std::vector<float> &values,
+                      const std::vector<float> &previous) {
+    for (size_t i = 0; i < values.size(); i++) {
+        uint64_t delta;
+        if (!GetVarint(in, end, delta)) {
+            return false;
+        }
+        values[i] = Float(static_cast<uint32_t>(delta) ^ (i < previous.size() ? Bits(previous[i]) : 0u));
+    }
+    return true;
+}
+
+/**
+ * Reader decodes the frames of a telemetry file in order.
+ */
+class Reader {
+public:
+    explicit Reader(const std::string &path) : in_(path, std::ios::binary) {
+        Header header, expected;
+        in_.read(reinterpret_cast<char *>(&header), sizeof(header));
+        ok_ = in_ && header.magic == expected.magic && header.version == expected.version &&
+              header.idSize == expected.idSize && header.columns == expected.columns;
+    }
+
+    /**
+     * Check if the file is a telemetry file of this build.
+     */
+    bool IsOpen() const {
+        return ok_;
+    }
+
+    /**
+     * Read the next frame. Returns false at the end of the file, or if the
+     * frame is truncated.
+     */
+    bool Next(Frame &frame) {
+        ChunkHeader chunk;
+        if (!ok_ || !in_.read(reinterpret_cast<char *>(&chunk), sizeof(chunk))) {
+            return false;
+        }
+        bytes_.resize(chunk.bytes);
+        if (!in_.read(reinterpret_cast<char *>(bytes_.data()), static_cast<std::streamsize>(chunk.bytes))) {
+            return false;
+        }
+        Frame next;
+        next.tick = chunk.tick;
+        next.ids.resize(chunk.count);
+        for (auto column : { &next.px, &next.py, &next.vx, &next.vy }) {
+            column->resize(chunk.count);
+        }
+        const uint8_t *in = bytes_.data();
+        const uint8_t *end = in + bytes_.size();
+        if (!GetIds(in, end, next.ids, previous_.ids) ||
+            !GetFloats(in, end, next.px, previous_.px) ||
+            !GetFloats(in, end, next.py, previous_.py) ||
+            !GetFloats(in, end, next.vx, previous_.vx) ||
+            !GetFloats(in, end, next.vy, previous_.vy)) {
+            return false;
+        }
+        previous_ = next;
+        frame = std::move(next);
+        return true;
+    }
+
+private:
+    std::ifstream       in_;
+    bool                ok_{ false };
+    std::vector<uint8_t> bytes_{};
+    Frame           previous_{};
+};
+
+}  // telemetry
+
+/**
+ * Telemetry exports the positions and velocities of the agents to a file
+ * without blocking the simulation. Record copies the Transform and Move
+ * columns of a sampled tick into a slot of a single-producer single-consumer
+ * ring; a background thread encodes the frames in the ring and writes them
+ * in chunks, one per frame, with delta-encoded columns. When the writer
+ * falls behind and the ring is full, frames are dropped and counted rather
+ * than waited for.
+ *
+ * Record must be called from one thread at a time, e.g. by a system.
+ */
+class Telemetry {
+public:
+    /**
+     * Open the file and start the writer. Every tick divisible by every is
+     * sampled, and up to frames frames wait in the ring.
+     */
+    explicit Telemetry(const std::string &path, uint64_t every = 1, size_t frames = 64)
+        : out_(path, std::ios::binary | std::ios::trunc),
+          every_(every == 0 ? 1 : every),
+          ring_(frames == 0 ? 1 : frames) {
+        if (!out_) {
+            return;
+        }
+        telemetry::Header header;
+        out_.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        thread_ = std::thread([this]() { Write(); });
+    }
+
+    /**
+     * Write the frames left in the ring and stop the writer.
+     */
+    ~Telemetry() {
+        stop_ = true;
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    Telemetry(const Telemetry &) = delete;
+    Telemetry &operator=(const Telemetry &) = delete;
+
+    /**
+     * Check if the file could be opened.
+     */
+    bool IsOpen() const {
+        return thread_.joinable();
+    }
+
+    /**
+     * Copy the agents of a tick into the ring, if the tick is sampled.
+     * Returns false if the frame was dropped, because the ring is full or
+     * the file isn't open. The slots keep their memory, so after the first
+     * laps this doesn't allocate unless the crowd grows.
+     */
+    bool Record(ecs::Scene &scene, uint64_t tick) {
+        if (tick % every_ != 0) {
+            return true;
+        }
+        auto head = head_.load(std::memory_order_relaxed);
+        if (!IsOpen() || head - tail_.load(std::memory_order_acquire) == ring_.size()) {
+            dropped_++;
+            return false;
+        }
+
+        auto &frame = ring_[head % ring_.size()];
+        frame.tick = tick;
+        frame.ids.clear();
+        frame.px.clear(); frame.py.clear();
+        frame.vx.clear(); frame.vy.clear();
+        ecs::SceneView<component::Transform, component::Move>(scene).Each([&](
+                ecs::Entity::Id       id,
+                component::Transform &t,
+                component::Move      &m) {
+            frame.ids.push_back(id);
+            frame.px.push_back(t.position.x); frame.py.push_back(t.position.y);
+            frame.vx.push_back(m.velocity.x); frame.vy.push_back(m.velocity.y);
+        });
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Wait until the recorded frames are written to the file.
+     */
+    void Flush() const {
+        auto head = head_.load(std::memory_order_relaxed);
+        while (IsOpen() && written_.load(std::memory_order_acquire) < head) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    /**
+     * Get the number of sampled frames dropped because the ring was full.
+     */
+    uint64_t GetDropped() const {
+        return dropped_;
+    }
+
+    /**
+     * Get the number of bytes written to the file so far.
+     */
+    uint64_t GetBytes() const {
+        return bytes_;
+    }
+
+private:
+    void Write() {
+        std::vector<uint8_t> columns;
+        telemetry::Frame previous;
+        while (true) {
+            // Read stop before the head, so the last frames aren't missed
+            auto stop = stop_.load();
+            auto head = head_.load(std::memory_order_acquire);
+            auto tail = tail_.load(std::memory_order_relaxed);
+            if (tail == head) {
+                if (stop) {
+                    return;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+            for (; tail < head; tail++) {
+                auto &frame = ring_[tail % ring_.size()];
+                columns.clear();
+                telemetry::PutIds(columns, frame.ids, previous.ids);
+                telemetry::PutFloats(columns, frame.px, previous.px);
+                telemetry::PutFloats(columns, frame.py, previous.py);
+                telemetry::PutFloats(columns, frame.vx, previous.vx);
+                telemetry::PutFloats(columns, frame.vy, previous.vy);
+                std::swap(previous, frame);
+
+                telemetry::ChunkHeader chunk{ previous.tick, previous.ids.size(), columns.size() };
+                out_.write(reinterpret_cast<const char *>(&chunk), sizeof(chunk));
+                out_.write(reinterpret_cast<const char *>(columns.data()), static_cast<std::streamsize>(columns.size()));
+                bytes_ += sizeof(chunk) + columns.size();
+                // The slot now holds the older frame's memory, reused by Record
+                tail_.store(tail + 1, std::memory_order_release);
+            }
+            out_.flush();
+            written_.store(head, std::memory_order_release);
+        }
+    }
+
+    std::ofstream                   out_;
+    uint64_t                      every_{ 1 };
+    std::vector<telemetry::Frame>  ring_{};
+    std::atomic<uint64_t>          head_{ 0 };  // written by Record only
+    std::atomic<uint64_t>          tail_{ 0 };  // written by the writer only
+    std::atomic<uint64_t>       written_{ 0 };  // frames flushed to the file
+    std::atomic<uint64_t>       dropped_{ 0 };
+    std::atomic<uint64_t>         bytes_{ 0 };
+    std::atomic<bool>              stop_{ false };
+    std::thread                  thread_{};
+};
+
+}  // steering
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace steering {
+/**
+ * ThreadPool is a work-stealing thread pool. Every worker owns a task queue:
+ * it pops its own tasks from the back and steals from the front of the other
+ * queues when its own is empty. Threads waiting for tasks help running them,
+ * so waiting from inside a task never deadlocks.
+ */
+class ThreadPool {
+public:
+    typedef std::function<void()> Task;
+
+    /**
+     * Constructor. With no workers, the tasks are run by the waiting thread.
+     */
+    explicit ThreadPool(size_t workers = DefaultWorkers()) {
+        // The last queue is shared by the threads that aren't workers.
+        for (size_t i = 0; i <= workers; i++) {
+            queues_.push_back(std::make_unique<Queue>());
+        }
+        for (size_t i = 0; i < workers; i++) {
+            threads_.emplace_back([this, i]() { Work(i); });
+        }
+    }
+
+    /**
+     * Stop and join the workers. Queued tasks that haven't started are dropped.
+     */
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto &thread : threads_) {
+            thread.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /**
+     * Get the number of workers, which doesn't count the waiting threads.
+     */
+    size_t Size() const {
+        return threads_.size();
+    }
+
+    /**
+     * Get a default number of workers: one less than the hardware threads,
+     * leaving one for the thread that waits.
+     */
+    static size_t DefaultWorkers() {
+        auto n = std::thread::hardware_concurrency();
+        return n > 1 ? n - 1 : 0;
+    }
+
+    /**
+     * Queue a task. A task submitted from a worker goes to the worker's own
+     * queue, so related work stays on the same thread unless it's stolen.
+     */
+    void Submit(Task task) {
+        auto &queue = *queues_[Self()];
+        pending_++;
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+        }
+        cv_.notify_one();
+    }
+
+    /**
+     * Run one queued task on the calling thread, if any.
+     * Returns false if no task was found.
+     */
+    bool RunOne() {
+        Task task;
+        if (!Pop(task)) {
+            return false;
+        }
+        task();
+        return true;
+    }
+
+    /**
+     * Run queued tasks on the calling thread until the predicate is true.
+     */
+    template<class Pred>
+    void Wait(Pred &&done) {
+        while (!done()) {
+            if (!RunOne()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    struct Queue {
+        std::mutex       mutex{};
+        std::deque<Task> tasks{};
+    };
+
+    /**
+     * Worker identity of the calling thread.
+     */
+    struct Worker {
+        const ThreadPool *pool{ nullptr };
+        size_t           index{ 0 };
+    };
+
+    static Worker &Current() {
+        static thread_local Worker worker;
+        return worker;
+    }
+
+    /**
+     * Get the queue of the calling thread.
+     */
+    size_t Self() const {
+        auto &worker = Current();
+        return worker.pool == this ? worker.index : queues_.size() - 1;
+    }
+
+    bool Pop(Task &task) {
+        if (pending_ == 0) {
+            return false;
+        }
+        // Own queue first, newest task
+        auto self = Self();
+        {
+            auto &queue = *queues_[self];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.tasks.empty()) {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+                pending_--;
+                return true;
+            }
+        }
+        // Steal the oldest task of another queue
+        for (size_t n = 1; n < queues_.size(); n++) {
+            auto &queue = *queues_[(self + n) % queues_.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.tasks.empty()) {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                pending_--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void Work(size_t index) {
+        Current() = Worker{ this, index };
+        while (true) {
+            if (RunOne()) {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (stop_) {
+                return;
+            }
+            cv_.wait_for(lock, std::chrono::milliseconds(1),
+                         [this]() { return stop_ || 0 < pending_; });
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue>> queues_{};
+    std::vector<std::thread>           threads_{};
+    std::atomic<size_t>                pending_{ 0 };
+    std::mutex                           mutex_{};
+    std::condition_variable                 cv_{};
+    bool                                  stop_{ false };
+};
+
+}  // steering
@@ -1,11 +1,28 @@
 #pragma once
 
+#include <cmath>
+#include <cstddef>
+
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "Component.h"
 
 namespace steering {
+/**
+ * Get the cosine and sine of the rotation to a heading. The heading vector
+ * already holds them, so no trigonometry is needed: it is only normalized.
+ * A zero heading is no rotation. The rotation is negated because y points
+ * downwards in SDL.
+ */
+inline glm::vec2 Rotation(const glm::vec2 &heading) {
+    auto l2 = heading.x * heading.x + heading.y * heading.y;
+    auto inv = 0.0f < l2 ? 1.0f / std::sqrt(l2) : 0.0f;
+    auto c = 0.0f < l2 ? heading.x * inv : 1.0f;
+    auto s = -heading.y * inv;
+    return glm::vec2(c, s);
+}
+
 /**
  * Transform Matrix (2D)
  */
@@ -21,9 +38,9 @@ inline glm::mat3 TransformMatrix(
     transform[1][1] = scale.y;
 
     // Apply rotation
-    float rotation = std::atan2(-heading.y, heading.x); // Downwards if positive in SDL
-    float c = std::cos(rotation);
-    float s = std::sin(rotation);
+    auto r = Rotation(heading);
+    float c = r.x;
+    float s = r.y;
     glm::mat3 rotate(
         c, -s,  0,
         s,  c,  0,
@@ -38,7 +55,8 @@ inline glm::mat3 TransformMatrix(
 }
 
 /**
- * Transform a local point to the world space in 2D
+ * Transform a local point to the world space in 2D. This is the product of
+ * TransformMatrix and the point, without building the matrix.
  */
 inline glm::vec2 ToWorld(
     const glm::vec2 &point,
@@ -46,11 +64,28 @@ inline glm::vec2 ToWorld(
     const glm::vec2 &heading,
     const glm::vec2 &scale)
 {
-    glm::mat3 transform = TransformMatrix(position, heading, scale);
+    auto r = Rotation(heading);
+    auto x = point.x * scale.x;
+    auto y = point.y * scale.y;
+    return glm::vec2(position.x + (r.x * x + r.y * y),
+                     position.y + (r.x * y - r.y * x));
+}
 
-    glm::vec3 local(point, 1.0f);
-    glm::vec3 world = transform * local;
-    return glm::vec2(world.x, world.y);
+/**
+ * Transform n local points to the world space, one per agent, e.g. the
+ * points of a crowd. The result of every point is the same as ToWorld's.
+ */
+inline void ToWorldN(
+    size_t n,
+    const glm::vec2 *points,
+    const glm::vec2 *positions,
+    const glm::vec2 *headings,
+    const glm::vec2 &scale,
+    glm::vec2 *world)
+{
+    for (size_t i = 0; i < n; i++) {
+        world[i] = ToWorld(points[i], positions[i], headings[i], scale);
+    }
 }
 
 }  // steering
@@ -1,6 +1,116 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+#include <SDL.h>
+
 #include "Game.h"
+#include "Simulation.h"
+
+namespace {
+
+/**
+ * Step the simulation as fast as possible, without a window. With a trace
+ * path, the timings of every system are written there as a Chrome trace.
+ * The agents can be restored from a checkpoint before the steps, and saved
+ * to one after them. With an LOD distance, agents farther than it from
+ * their target update their steering every 2 or 4 ticks.
+ */
+void RunHeadless(unsigned long long steps, const char *trace,
+                 const char *load, const char *save,
+                 const char *telemetry, unsigned long long sample,
+                 const char *lod) {
+    steering::Simulation simulation;
+    simulation.Init();
+    if (lod != nullptr) {
+        steering::lod::Config config;
+        config.near = static_cast<float>(std::strtod(lod, nullptr));
+        config.levels = 3;
+        simulation.SetLod(config);
+    }
+    std::unique_ptr<steering::Telemetry> exporter;
+    if (telemetry != nullptr) {
+        exporter = std::make_unique<steering::Telemetry>(telemetry, sample);
+        if (!exporter->IsOpen()) {
+            SDL_Log("Can't write the telemetry to %s", telemetry);
+            return;
+        }
+        simulation.SetTelemetry(exporter.get());
+    }
+    if (load != nullptr) {
+        auto start = std::chrono::steady_clock::now();
+        if (!simulation.Load(load)) {
+            SDL_Log("Can't load the checkpoint %s", load);
+            return;
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        SDL_Log("Loaded %s in %f s", load, elapsed.count());
+    }
+    auto &profiler = simulation.GetProfiler();
+    profiler.Capture(trace != nullptr);
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long long n = 0; n < steps; n++) {
+        simulation.Step(steering::FIXED_DT);
+        profiler.EndFrame();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    SDL_Log("%llu steps in %f s (%f steps/s)", steps, elapsed.count(), steps / elapsed.count());
+
+    for (auto &name : profiler.GetNames()) {
+        SDL_Log("%-28s p50 %7.3f ms  p95 %7.3f ms", name.c_str(),
+                profiler.Percentile(name, 50.0),
+                profiler.Percentile(name, 95.0));
+    }
+    if (trace != nullptr && !profiler.WriteChromeTrace(trace)) {
+        SDL_Log("Can't write the trace to %s", trace);
+    }
+    if (save != nullptr && !simulation.Save(save)) {
+        SDL_Log("Can't save the checkpoint to %s", save);
+    }
+    if (exporter != nullptr) {
+        exporter->Flush();
+        SDL_Log("Telemetry: %llu bytes, %llu frames dropped",
+                static_cast<unsigned long long>(exporter->GetBytes()),
+                static_cast<unsigned long long>(exporter->GetDropped()));
+        simulation.SetTelemetry(nullptr);
+    }
+}
+
+}  // namespace
 
 int main (int argc, char* argv[]) {
+    const char *headless = nullptr;
+    const char *trace = nullptr;
+    const char *load = nullptr;
+    const char *save = nullptr;
+    const char *telemetry = nullptr;
+    const char *sample = "1";
+    const char *lod = nullptr;
+    for (auto i = 1; i + 1 < argc; i++) {
+        if (std::strcmp(argv[i], "--headless") == 0) {
+            headless = argv[i + 1];
+        } else if (std::strcmp(argv[i], "--trace") == 0) {
+            trace = argv[i + 1];
+        } else if (std::strcmp(argv[i], "--load") == 0) {
+            load = argv[i + 1];
+        } else if (std::strcmp(argv[i], "--save") == 0) {
+            save = argv[i + 1];
+        } else if (std::strcmp(argv[i], "--telemetry") == 0) {
+            telemetry = argv[i + 1];
+        } else if (std::strcmp(argv[i], "--sample") == 0) {
+            sample = argv[i + 1];
+        } else if (std::strcmp(argv[i], "--lod") == 0) {
+            lod = argv[i + 1];
+        }
+    }
+    if (headless != nullptr) {
+        RunHeadless(std::strtoull(headless, nullptr, 10), trace, load, save,
+                    telemetry, std::strtoull(sample, nullptr, 10), lod);
+        return 0;
+    }
+
     steering::Game game;
 
     if (game.Init()) {
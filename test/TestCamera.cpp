@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+
+#include "Camera.h"
+
+using steering::render::Camera;
+
+TEST(TestCamera, MapsWorldToScreen)
+{
+    Camera camera(glm::vec2(500.0f, 500.0f), glm::vec2(200.0f, 100.0f), 2.0f);
+    auto screen = camera.ToScreen(glm::vec2(510.0f, 490.0f));
+    EXPECT_FLOAT_EQ(screen.x, 120.0f);
+    EXPECT_FLOAT_EQ(screen.y, 30.0f);
+    auto world = camera.ToWorld(screen);
+    EXPECT_FLOAT_EQ(world.x, 510.0f);
+    EXPECT_FLOAT_EQ(world.y, 490.0f);
+
+    EXPECT_FLOAT_EQ(camera.Min().x, 450.0f);
+    EXPECT_FLOAT_EQ(camera.Min().y, 475.0f);
+    EXPECT_FLOAT_EQ(camera.Max().x, 550.0f);
+    EXPECT_FLOAT_EQ(camera.Max().y, 525.0f);
+}
+
+TEST(TestCamera, CullsOutsideViewport)
+{
+    Camera camera(glm::vec2(500.0f, 500.0f), glm::vec2(200.0f, 100.0f), 2.0f);
+    EXPECT_TRUE(camera.IsVisible(glm::vec2(500.0f, 500.0f), 0.0f));
+    EXPECT_FALSE(camera.IsVisible(glm::vec2(560.0f, 500.0f), 5.0f));
+    EXPECT_TRUE(camera.IsVisible(glm::vec2(560.0f, 500.0f), 10.0f));
+    EXPECT_FALSE(camera.IsVisible(glm::vec2(500.0f, 400.0f), 10.0f));
+}
+
+TEST(TestCamera, ZoomKeepsAnchor)
+{
+    Camera camera(glm::vec2(500.0f, 500.0f), glm::vec2(200.0f, 100.0f));
+    auto anchor = glm::vec2(30.0f, 80.0f);
+    auto before = camera.ToWorld(anchor);
+    camera.ZoomAt(anchor, 4.0f);
+    EXPECT_FLOAT_EQ(camera.zoom, 4.0f);
+    auto after = camera.ToWorld(anchor);
+    EXPECT_NEAR(after.x, before.x, 1e-3);
+    EXPECT_NEAR(after.y, before.y, 1e-3);
+}
@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <ECS.h>
+
+#include "Checkpoint.h"
+
+namespace {
+
+struct Position {
+    float x{ 0.0f };
+    float y{ 0.0f };
+};
+
+struct Velocity {
+    float x{ 0.0f };
+    float y{ 0.0f };
+};
+
+struct Tag {
+    int value{ 0 };
+};
+
+typedef steering::Checkpoint<Position, Velocity> TestCheckpoint;
+
+}  // namespace
+
+TEST(TestCheckpoint, RestoresEntitiesAndComponents)
+{
+    ecs::Scene scene;
+    std::vector<ecs::Entity::Id> ids;
+    for (auto i = 0; i < 100; i++) {
+        ids.push_back(scene.NewEntity());
+        scene.AddComponent<Position>(ids.back(), Position{ float(i), float(-i) });
+        if (i % 3 == 0) {
+            scene.AddComponent<Velocity>(ids.back(), Velocity{ 1.0f, float(i) });
+        }
+    }
+    for (auto i = 0; i < 100; i += 7) {
+        scene.RemoveEntity(ids[i]);
+    }
+    auto path = testing::TempDir() + "checkpoint.bin";
+    ASSERT_TRUE(TestCheckpoint::Save(scene, path));
+
+    ecs::Scene restored;
+    restored.DoubleBuffer<Position>();
+    restored.Group<Position, Velocity>();
+    restored.AddComponent<Position>(restored.NewEntity());
+    ASSERT_TRUE(TestCheckpoint::Load(restored, path));
+
+    ASSERT_EQ(restored.GetEntities().size(), scene.GetEntities().size());
+    EXPECT_EQ(restored.GetFreelist(), scene.GetFreelist());
+    for (auto i = 0; i < 100; i++) {
+        EXPECT_EQ(restored.IsAlive(ids[i]), i % 7 != 0);
+        if (i % 7 == 0) {
+            continue;
+        }
+        EXPECT_EQ(restored.GetComponent<Position>(ids[i])->x, float(i));
+        EXPECT_EQ(restored.GetFrontComponent<Position>(ids[i])->y, float(-i));
+        EXPECT_EQ(restored.HasComponent<Velocity>(ids[i]), i % 3 == 0);
+        if (i % 3 == 0) {
+            EXPECT_EQ(restored.GetComponent<Velocity>(ids[i])->y, float(i));
+        }
+    }
+
+    // The group is sorted again, and removed indices are reused the same way
+    auto group = restored.Group<Position, Velocity>();
+    auto members = ecs::SceneView<Position, Velocity>(scene).Size();
+    EXPECT_EQ(group->size_, members);
+    EXPECT_EQ(restored.NewEntity(), scene.NewEntity());
+    std::remove(path.c_str());
+}
+
+TEST(TestCheckpoint, RejectsOtherFiles)
+{
+    ecs::Scene scene;
+    auto id = scene.NewEntity();
+    scene.AddComponent<Position>(id, Position{ 1.0f, 2.0f });
+    auto path = testing::TempDir() + "checkpoint.bin";
+
+    // Components of other types couldn't be restored
+    scene.AddComponent<Tag>(id);
+    EXPECT_FALSE(TestCheckpoint::Save(scene, path));
+    scene.RemoveComponent<Tag>(id);
+    ASSERT_TRUE(TestCheckpoint::Save(scene, path));
+
+    ecs::Scene other;
+    auto kept = other.NewEntity();
+    EXPECT_FALSE((steering::Checkpoint<Velocity, Position>::Load(other, path)));
+    EXPECT_FALSE(steering::Checkpoint<Position>::Load(other, path));
+    EXPECT_FALSE(TestCheckpoint::Load(other, path + ".missing"));
+
+    // A truncated file is rejected as a whole
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size() / 2));
+    }
+    EXPECT_FALSE(TestCheckpoint::Load(other, path));
+    EXPECT_TRUE(other.IsAlive(kept));
+    std::remove(path.c_str());
+}
+
+TEST(TestCheckpoint, RejectsCorruptFiles)
+{
+    ecs::Scene scene;
+    for (auto i = 0; i < 3; i++) {
+        auto id = scene.NewEntity();
+        scene.AddComponent<Position>(id, Position{ float(i), 0.0f });
+        if (i == 1) {
+            scene.AddComponent<Velocity>(id);
+        }
+    }
+    auto path = testing::TempDir() + "checkpoint.bin";
+    ASSERT_TRUE(TestCheckpoint::Save(scene, path));
+    std::string saved;
+    {
+        std::ifstream in(path, std::ios::binary);
+        saved.assign((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    }
+
+    // Blocks of the file, each padded to the alignment
+    using steering::checkpoint::Padded;
+    auto entities = Padded(sizeof(steering::checkpoint::Header));
+    auto positions = entities + Padded(3 * sizeof(ecs::Scene::EntityPack));
+    auto dense = positions + Padded(sizeof(steering::checkpoint::PoolHeader)) + Padded(3 * sizeof(Position));
+
+    // Load a copy of the file with an edit, into a scene with one entity
+    auto load = [&](auto &&edit) {
+        auto bytes = saved;
+        edit(&bytes[0]);
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        }
+        ecs::Scene other;
+        other.NewEntity();
+        auto loaded = TestCheckpoint::Load(other, path);
+        EXPECT_EQ(other.GetEntities().size(), loaded ? 3u : 1u);
+        return loaded;
+    };
+    EXPECT_TRUE(load([](char *) {}));
+
+    // A count whose block size wraps around
+    EXPECT_FALSE(load([](char *bytes) {
+        reinterpret_cast<steering::checkpoint::Header *>(bytes)->entities = 1ull << 62;
+    }));
+    // A row of an entity out of range, or of another entity
+    EXPECT_FALSE(load([&](char *bytes) {
+        reinterpret_cast<ecs::Entity::Index *>(bytes + dense)[0] = 7;
+    }));
+    EXPECT_FALSE(load([&](char *bytes) {
+        reinterpret_cast<ecs::Entity::Index *>(bytes + dense)[0] = 1;
+    }));
+    // A mask with a component the pool doesn't have
+    EXPECT_FALSE(load([&](char *bytes) {
+        auto pack = reinterpret_cast<ecs::Scene::EntityPack *>(bytes + entities);
+        pack[0].mask_.set(ecs::Component::GetId<Velocity>());
+    }));
+    std::remove(path.c_str());
+}
@@ -0,0 +1,645 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ECS.h>
+
+namespace {
+
+struct Position {
+    Position() = default;
+    Position(float x, float y) : x(x), y(y) {}
+
+    float x{ 0.0f };
+    float y{ 0.0f };
+};
+
+struct Velocity {
+    Velocity() = default;
+    Velocity(float x, float y) : x(x), y(y) {}
+
+    float x{ 0.0f };
+    float y{ 0.0f };
+};
+
+}  // namespace
+
+TEST(TestECS, PoolGrowsOnDemand)
+{
+    ecs::ComponentPool pool(sizeof(Position));
+    EXPECT_EQ(pool.Size(), 0u);
+    EXPECT_FALSE(pool.Has(10));
+
+    new (pool.Add(10)) Position(1.0f, 2.0f);
+    EXPECT_TRUE(pool.Has(10));
+    EXPECT_FALSE(pool.Has(9));
+    EXPECT_EQ(pool.Size(), 1u);
+    EXPECT_EQ(pool.Entities()[0], 10u);
+}
+
+TEST(TestECS, PoolRemoveKeepsRowsPacked)
+{
+    ecs::ComponentPool pool(sizeof(Position));
+    for (ecs::Entity::Index i = 0; i < 4; i++) {
+        new (pool.Add(i)) Position(float(i), float(i));
+    }
+
+    pool.Remove(1);
+    EXPECT_EQ(pool.Size(), 3u);
+    EXPECT_FALSE(pool.Has(1));
+
+    // The last row is moved into the freed one.
+    EXPECT_EQ(pool.Entities()[1], 3u);
+    EXPECT_EQ(static_cast<Position *>(pool.Get(3))->x, 3.0f);
+    EXPECT_EQ(static_cast<Position *>(pool.Data())[1].x, 3.0f);
+}
+
+TEST(TestECS, AddAndGetComponent)
+{
+    ecs::Scene scene;
+    auto e1 = scene.NewEntity();
+    auto e2 = scene.NewEntity();
+    scene.AddComponent<Position>(e1, 1.0f, 2.0f);
+    scene.AddComponent<Position>(e2, 3.0f, 4.0f);
+    scene.AddComponent<Velocity>(e2, 5.0f, 6.0f);
+
+    EXPECT_TRUE(scene.HasComponent<Position>(e1));
+    EXPECT_FALSE(scene.HasComponent<Velocity>(e1));
+    EXPECT_EQ(scene.GetComponent<Position>(e1)->y, 2.0f);
+    EXPECT_EQ(scene.GetComponent<Position>(e2)->x, 3.0f);
+    EXPECT_EQ(scene.GetComponent<Velocity>(e2)->y, 6.0f);
+}
+
+TEST(TestECS, RemoveEntityReleasesComponents)
+{
+    ecs::Scene scene;
+    auto e1 = scene.NewEntity();
+    auto e2 = scene.NewEntity();
+    scene.AddComponent<Position>(e1, 1.0f, 1.0f);
+    scene.AddComponent<Position>(e2, 2.0f, 2.0f);
+
+    scene.RemoveEntity(e1);
+    EXPECT_FALSE(ecs::Entity::IsValid(scene.GetEntities()[0].id_));
+    EXPECT_EQ(scene.GetComponent<Position>(e2)->x, 2.0f);
+
+    // The freed index is reused with a bumped version.
+    auto e3 = scene.NewEntity();
+    EXPECT_EQ(ecs::Entity::GetIndex(e3), ecs::Entity::GetIndex(e1));
+    EXPECT_NE(e3, e1);
+    EXPECT_FALSE(scene.HasComponent<Position>(e3));
+}
+
+TEST(TestECS, SceneViewMatchesMask)
+{
+    ecs::Scene scene;
+    auto e1 = scene.NewEntity();
+    auto e2 = scene.NewEntity();
+    auto e3 = scene.NewEntity();
+    scene.AddComponent<Position>(e1);
+    scene.AddComponent<Position>(e2);
+    scene.AddComponent<Velocity>(e2);
+    scene.AddComponent<Velocity>(e3);
+
+    std::vector<ecs::Entity::Id> ids;
+    for (auto id : ecs::SceneView<Position, Velocity>(scene)) {
+        ids.push_back(id);
+    }
+    ASSERT_EQ(ids.size(), 1u);
+    EXPECT_EQ(ids[0], e2);
+}
+
+TEST(TestECS, SceneViewWithoutPoolIsEmpty)
+{
+    struct Unused {};
+
+    ecs::Scene scene;
+    auto e1 = scene.NewEntity();
+    scene.AddComponent<Position>(e1);
+
+    auto view = ecs::SceneView<Position, Unused>(scene);
+    EXPECT_TRUE(view.begin() == view.end());
+}
+
+TEST(TestECS, SceneViewSkipsRemovedEntities)
+{
+    ecs::Scene scene;
+    auto e1 = scene.NewEntity();
+    auto e2 = scene.NewEntity();
+    auto e3 = scene.NewEntity();
+    scene.AddComponent<Position>(e1);
+    scene.AddComponent<Position>(e2);
+    scene.AddComponent<Position>(e3);
+    scene.RemoveEntity(e1);
+
+    std::vector<ecs::Entity::Id> ids;
+    for (auto id : ecs::SceneView<Position>(scene)) {
+        ids.push_back(id);
+    }
+    ASSERT_EQ(ids.size(), 2u);
+
+    size_t count = 0;
+    for (auto id : ecs::SceneView<>(scene)) {
+        EXPECT_NE(id, e1);
+        count++;
+    }
+    EXPECT_EQ(count, 2u);
+}
+
+TEST(TestECS, GroupPacksMatchingEntitiesFirst)
+{
+    ecs::Scene scene;
+    auto e1 = scene.NewEntity();
+    auto e2 = scene.NewEntity();
+    auto e3 = scene.NewEntity();
+    scene.AddComponent<Position>(e1, 1.0f, 0.0f);
+    scene.AddComponent<Position>(e2, 2.0f, 0.0f);
+    scene.AddComponent<Position>(e3, 3.0f, 0.0f);
+    scene.AddComponent<Velocity>(e3, 3.0f, 0.0f);
+
+    auto group = scene.Group<Position, Velocity>();
+    EXPECT_EQ(group->size_, 1u);
+
+    scene.AddComponent<Velocity>(e1, 1.0f, 0.0f);
+    EXPECT_EQ(group->size_, 2u);
+
+    auto positions  = static_cast<Position *>(scene.GetPool(ecs::Component::GetId<Position>())->Data());
+    auto velocities = static_cast<Velocity *>(scene.GetPool(ecs::Component::GetId<Velocity>())->Data());
+    for (uint64_t row = 0; row < group->size_; row++) {
+        EXPECT_EQ(positions[row].x, velocities[row].x);
+    }
+    EXPECT_EQ(scene.GetComponent<Position>(e1)->x, 1.0f);
+    EXPECT_EQ(scene.GetComponent<Velocity>(e1)->x, 1.0f);
+
+    scene.RemoveComponent<Velocity>(e3);
+    EXPECT_EQ(group->size_, 1u);
+    EXPECT_EQ(positions[0].x, 1.0f);
+
+    scene.RemoveEntity(e1);
+    EXPECT_EQ(group->size_, 0u);
+    EXPECT_EQ(scene.GetComponent<Position>(e2)->x, 2.0f);
+}
+
+TEST(TestECS, ChunkViewCoversGroup)
+{
+    ecs::Scene scene;
+    const auto count = ecs::CHUNK_SIZE * 2 + 3;
+    for (uint64_t n = 0; n < count; n++) {
+        auto id = scene.NewEntity();
+        scene.AddComponent<Position>(id, float(n), 0.0f);
+        if (n % 2 == 0) {
+            scene.AddComponent<Velocity>(id, float(n), 0.0f);
+        }
+    }
+
+    uint64_t total = 0;
+    uint64_t chunks = 0;
+    for (auto chunk : ecs::ChunkView<Position, Velocity>(scene)) {
+        auto p = chunk.Get<Position>();
+        auto v = chunk.Get<Velocity>();
+        for (uint64_t i = 0; i < chunk.Size(); i++) {
+            EXPECT_EQ(p[i].x, v[i].x);
+            EXPECT_EQ(static_cast<uint64_t>(p[i].x), chunk.Entities()[i]);
+        }
+        total += chunk.Size();
+        chunks++;
+    }
+    EXPECT_EQ(total, (count + 1) / 2);
+    EXPECT_EQ(chunks, 1u + ((count + 1) / 2 - 1) / ecs::CHUNK_SIZE);
+}
+
+TEST(TestECS, SceneViewEachYieldsComponents)
+{
+    ecs::Scene scene;
+    auto e1 = scene.NewEntity();
+    auto e2 = scene.NewEntity();
+    auto e3 = scene.NewEntity();
+    scene.AddComponent<Position>(e1, 1.0f, 1.0f);
+    scene.AddComponent<Velocity>(e1, 1.0f, 2.0f);
+    scene.AddComponent<Position>(e2, 2.0f, 2.0f);
+    scene.AddComponent<Position>(e3, 3.0f, 3.0f);
+    scene.AddComponent<Velocity>(e3, 3.0f, 4.0f);
+
+    ecs::SceneView<Position, Velocity>(scene).Each([](Position &p, Velocity &v) {
+        p.x += v.x;
+        p.y += v.y;
+    });
+    EXPECT_EQ(scene.GetComponent<Position>(e1)->x, 2.0f);
+    EXPECT_EQ(scene.GetComponent<Position>(e1)->y, 3.0f);
+    EXPECT_EQ(scene.GetComponent<Position>(e2)->x, 2.0f);
+    EXPECT_EQ(scene.GetComponent<Position>(e3)->y, 7.0f);
+
+    std::vector<ecs::Entity::Id> ids;
+    ecs::SceneView<Velocity>(scene).Each([&](ecs::Entity::Id id, Velocity &) {
+        ids.push_back(id);
+    });
+    ASSERT_EQ(ids.size(), 2u);
+    EXPECT_EQ(ids[0], e1);
+    EXPECT_EQ(ids[1], e3);
+}
+
+TEST(TestECS, SnapshotKeepsCapturedState)
+{
+    ecs::Scene scene;
+    auto a = scene.NewEntity();
+    auto b = scene.NewEntity();
+    scene.AddComponent<Position>(a, Position{ 1.0f, 2.0f });
+
+    ecs::Snapshot<Position> snapshot;
+    snapshot.Capture(scene);
+    scene.GetComponent<Position>(a)->x = 5.0f;
+
+    ASSERT_NE(snapshot.Get(a), nullptr);
+    EXPECT_EQ(snapshot.Get(a)->x, 1.0f);
+    EXPECT_EQ(snapshot.Get(b), nullptr);
+}
+
+TEST(TestECS, DoubleBufferKeepsFrontUntilSwap)
+{
+    ecs::Scene scene;
+    scene.DoubleBuffer<Position>();
+    auto a = scene.NewEntity();
+    auto b = scene.NewEntity();
+    scene.AddComponent<Position>(a, 1.0f, 1.0f);
+    scene.AddComponent<Position>(b, 2.0f, 2.0f);
+    EXPECT_EQ(scene.GetFrontComponent<Position>(b)->x, 2.0f);
+
+    scene.GetComponent<Position>(b)->x = 3.0f;
+    EXPECT_EQ(scene.GetFrontComponent<Position>(b)->x, 2.0f);
+
+    // The front copy follows the row moved by the removal
+    scene.RemoveEntity(a);
+    EXPECT_EQ(scene.GetFrontComponent<Position>(a), nullptr);
+    EXPECT_EQ(scene.GetFrontComponent<Position>(b)->x, 2.0f);
+
+    scene.SwapBuffers();
+    EXPECT_EQ(scene.GetFrontComponent<Position>(b)->x, 3.0f);
+}
+
+TEST(TestECS, CreateBatchCopiesPrototype)
+{
+    ecs::Scene scene;
+    auto group = scene.Group<Position, Velocity>();
+    auto loner = scene.NewEntity();
+    scene.RemoveEntity(loner);
+
+    auto ids = scene.CreateBatch(100, Position(1.0f, 2.0f), Velocity(3.0f, 4.0f));
+    ASSERT_EQ(ids.size(), 100u);
+    // The freed index is reused first
+    EXPECT_EQ(ecs::Entity::GetIndex(ids[0]), ecs::Entity::GetIndex(loner));
+    EXPECT_EQ(ecs::Entity::GetVersion(ids[0]), 1u);
+    for (auto id : ids) {
+        ASSERT_TRUE(scene.HasComponent<Position>(id));
+        EXPECT_EQ(scene.GetComponent<Position>(id)->y, 2.0f);
+        EXPECT_EQ(scene.GetComponent<Velocity>(id)->x, 3.0f);
+    }
+    EXPECT_EQ(group->size_, 100u);
+}
+
+TEST(TestECS, DestroyBatchRemovesEntities)
+{
+    ecs::Scene scene;
+    auto group = scene.Group<Position, Velocity>();
+    auto keep = scene.NewEntity();
+    scene.AddComponent<Position>(keep, 7.0f, 7.0f);
+    scene.AddComponent<Velocity>(keep, 7.0f, 7.0f);
+
+    std::vector<ecs::Entity::Id> ids;
+    for (auto id : scene.CreateBatch(50, Position(), Velocity())) {
+        ids.push_back(id);
+    }
+    scene.DestroyBatch(ids);
+
+    EXPECT_EQ(group->size_, 1u);
+    EXPECT_EQ(scene.GetPool(ecs::Component::GetId<Position>())->Size(), 1u);
+    EXPECT_EQ(scene.GetComponent<Position>(keep)->x, 7.0f);
+    for (auto id : ids) {
+        EXPECT_FALSE(ecs::Entity::IsValid(scene.GetEntities()[ecs::Entity::GetIndex(id)].id_));
+    }
+}
+
+namespace {
+
+struct Registered {
+    int value{ 0 };
+};
+
+}  // namespace
+
+ECS_COMPONENT_ID(Registered, 20)
+
+TEST(TestECS, RegisteredComponentHasStaticId)
+{
+    static_assert(ecs::Component::Traits<Registered>::STATIC);
+    EXPECT_EQ(ecs::Component::GetId<Registered>(), 20u);
+    EXPECT_GE(ecs::Component::GetId<Position>(), ecs::Component::STATIC_COMPONENTS);
+    EXPECT_EQ(ecs::Component::MaskOf<Registered>(), ecs::ComponentMask(1ull << 20));
+
+    ecs::Scene scene;
+    auto id = scene.NewEntity();
+    scene.AddComponent<Registered>(id)->value = 3;
+    auto count = 0;
+    ecs::SceneView<Registered>(scene).Each([&](Registered &r) {
+        EXPECT_EQ(r.value, 3);
+        count++;
+    });
+    EXPECT_EQ(count, 1);
+}
+
+namespace {
+
+struct Named {
+    std::string name{};
+};
+
+}  // namespace
+
+TEST(TestECS, RegistryRecordsComponentInfo)
+{
+    auto &registry = ecs::ComponentRegistry::Instance();
+    auto named = registry.Register<Named>();
+    EXPECT_EQ(named, ecs::Component::GetId<Named>());
+    EXPECT_TRUE(registry.IsRegistered(named));
+    EXPECT_FALSE(registry.GetInfo(named).trivial);
+    EXPECT_EQ(registry.GetInfo(named).size, sizeof(Named));
+    EXPECT_EQ(registry.GetInfo(named).alignment, alignof(Named));
+    EXPECT_FALSE(registry.IsRegistered(ecs::MAX_COMPONENTS));
+    EXPECT_THROW(registry.GetInfo(ecs::MAX_COMPONENTS), std::out_of_range);
+
+    // Creating a pool registers its type, and the pool keeps the info
+    ecs::Scene scene;
+    scene.AddComponent<Registered>(scene.NewEntity());
+    EXPECT_TRUE(registry.IsRegistered(20));
+    EXPECT_TRUE(registry.GetInfo(20).trivial);
+    EXPECT_EQ(scene.GetPool(20)->GetInfo().size, sizeof(Registered));
+    EXPECT_EQ(scene.GetPool(ecs::MAX_COMPONENTS), nullptr);
+}
+
+namespace {
+
+struct alignas(128) Wide {
+    float values[32]{};
+};
+
+}  // namespace
+
+TEST(TestECS, ArenaAlignsPoolsAndResets)
+{
+    ecs::Arena arena(1 << 20);
+    ecs::Scene scene(&arena);
+    EXPECT_EQ(scene.GetAllocator(), &arena);
+    scene.DoubleBuffer<Position>();
+    std::vector<ecs::Entity::Id> ids;
+    for (auto i = 0; i < 100; i++) {
+        ids.push_back(scene.NewEntity());
+        scene.AddComponent<Position>(ids.back(), float(i), 0.0f);
+        scene.AddComponent<Wide>(ids.back());
+    }
+    auto positions = scene.GetPool(ecs::Component::GetId<Position>());
+    auto wides = scene.GetPool(ecs::Component::GetId<Wide>());
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(positions->Data()) % ecs::POOL_ALIGNMENT, 0u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(wides->Data()) % alignof(Wide), 0u);
+    EXPECT_LT(0u, arena.GetUsed());
+
+    // A snapshot is copied to the heap, so it outlives the reset
+    ecs::Snapshot<Position> snapshot;
+    snapshot.Capture(scene);
+    scene.Clear();
+    arena.Reset();
+    EXPECT_EQ(arena.GetUsed(), 0u);
+    EXPECT_TRUE(scene.GetEntities().empty());
+    EXPECT_EQ(snapshot.Get(ids[42])->x, 42.0f);
+
+    // The pools keep their settings for the next run
+    auto id = scene.NewEntity();
+    scene.AddComponent<Position>(id, 1.0f, 2.0f);
+    EXPECT_EQ(scene.GetFrontComponent<Position>(id)->y, 2.0f);
+    EXPECT_EQ(positions->Size(), 1u);
+
+    // Pools of the heap are aligned too
+    ecs::Scene heap;
+    heap.AddComponent<Wide>(heap.NewEntity());
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(heap.GetPool(ecs::Component::GetId<Wide>())->Data()) % alignof(Wide), 0u);
+}
+
+TEST(TestECS, ArenaThrowsWhenExhausted)
+{
+    ecs::Arena arena(1 << 20);
+    auto capacity = arena.GetCapacity();
+    EXPECT_NE(arena.Allocate(capacity - 64, 64), nullptr);
+    EXPECT_THROW(arena.Allocate(128, 64), std::bad_alloc);
+    EXPECT_EQ(arena.GetUsed(), capacity - 64);
+    EXPECT_NE(arena.Allocate(64, 64), nullptr);
+
+    // A pool that can't grow keeps its components
+    arena.Reset();
+    ecs::Scene scene(&arena);
+    auto id = scene.NewEntity();
+    scene.AddComponent<Position>(id, 1.0f, 2.0f);
+    arena.Allocate(capacity - arena.GetUsed(), 1);
+    std::vector<ecs::Entity::Id> ids;
+    EXPECT_THROW({
+        for (auto i = 0; i < 1000; i++) {
+            ids.push_back(scene.NewEntity());
+            scene.AddComponent<Position>(ids.back(), 3.0f, 4.0f);
+        }
+    }, std::bad_alloc);
+    EXPECT_EQ(scene.GetComponent<Position>(id)->y, 2.0f);
+}
+
+TEST(TestECS, PrefabInstantiatesCopies)
+{
+    using Agent = ecs::Prefab<Position, Velocity, Registered>;
+    static_assert(!Agent::STATIC);
+    static_assert(Agent::BYTES == sizeof(Position) + sizeof(Velocity) + sizeof(Registered));
+
+    Agent prefab(Position(1.0f, 2.0f), Velocity(3.0f, 4.0f), Registered{ 5 });
+    auto mask = Agent::Mask();
+    EXPECT_EQ(mask.count(), 3u);
+
+    ecs::Scene scene;
+    auto first = prefab.Instantiate(scene, 10);
+    EXPECT_EQ(first.size(), 10u);
+    prefab.Get<Position>().x = 9.0f;
+    auto second = prefab.Instantiate(scene, 5);
+    EXPECT_EQ(second.size(), 5u);
+
+    auto moved = 0;
+    ecs::SceneView<Position, Velocity, Registered>(scene).Each([&](
+            Position   &p,
+            Velocity   &v,
+            Registered &r) {
+        EXPECT_EQ(v.y, 4.0f);
+        EXPECT_EQ(r.value, 5);
+        moved += p.x == 9.0f;
+    });
+    EXPECT_EQ(moved, 5);
+    for (auto &pack : scene.GetEntities()) {
+        EXPECT_EQ(pack.mask_, mask);
+    }
+}
+
+TEST(TestECS, CommandBufferDefersChanges)
+{
+    ecs::Scene scene;
+    std::vector<ecs::Entity::Id> ids;
+    for (auto i = 0; i < 4; i++) {
+        ids.push_back(scene.NewEntity());
+        scene.AddComponent<Position>(ids.back(), static_cast<float>(i), 0.0f);
+    }
+
+    ecs::CommandBuffer commands;
+    auto visited = 0;
+    ecs::SceneView<Position>(scene).Each([&](ecs::Entity::Id id, Position &p) {
+        visited++;
+        if (p.x == 0.0f) {
+            commands.Despawn(id);
+            commands.Add(id, Velocity(1.0f, 1.0f));  // dropped, the entity is gone
+        } else if (p.x == 1.0f) {
+            commands.Add(id, Velocity(2.0f, 2.0f));
+        } else if (p.x == 2.0f) {
+            commands.Remove<Position>(id);
+        }
+    });
+    commands.Spawn(Position(9.0f, 9.0f), Velocity(9.0f, 9.0f));
+    EXPECT_EQ(visited, 4);
+    EXPECT_EQ(commands.Size(), 5u);
+    EXPECT_TRUE(scene.IsAlive(ids[0]));
+
+    commands.Playback(scene);
+    EXPECT_EQ(commands.Size(), 0u);
+    EXPECT_FALSE(scene.IsAlive(ids[0]));
+    EXPECT_EQ(scene.GetComponent<Velocity>(ids[1])->x, 2.0f);
+    EXPECT_FALSE(scene.HasComponent<Position>(ids[2]));
+    EXPECT_TRUE(scene.HasComponent<Position>(ids[3]));
+
+    // The spawned entity reuses the freed index
+    auto count = 0;
+    ecs::SceneView<Position, Velocity>(scene).Each([&](ecs::Entity::Id id, Position &p, Velocity &) {
+        if (p.x == 9.0f) {
+            EXPECT_EQ(ecs::Entity::GetIndex(id), ecs::Entity::GetIndex(ids[0]));
+            count++;
+        }
+    });
+    EXPECT_EQ(count, 1);
+}
+
+TEST(TestECS, CommandQueueCollectsEveryThread)
+{
+    ecs::Scene scene;
+    std::vector<ecs::Entity::Id> ids;
+    for (auto i = 0; i < 400; i++) {
+        ids.push_back(scene.NewEntity());
+        scene.AddComponent<Position>(ids.back());
+    }
+
+    ecs::CommandQueue queue;
+    std::vector<std::thread> threads;
+    for (auto t = 0; t < 4; t++) {
+        threads.emplace_back([&, t]() {
+            for (auto i = t; i < 400; i += 4) {
+                queue.Local().Despawn(ids[i]);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    queue.Playback(scene);
+
+    EXPECT_EQ(scene.GetPool(ecs::Component::GetId<Position>())->Size(), 0u);
+    for (auto id : ids) {
+        EXPECT_FALSE(scene.IsAlive(id));
+    }
+}
+
+TEST(TestECS, EntityIdPacksIndexAndVersion)
+{
+    using namespace ecs::Entity;
+    auto id = NewId(INVALID_INDEX - 1, VERSION_MASK);
+    EXPECT_EQ(GetIndex(id), INVALID_INDEX - 1);
+    EXPECT_EQ(GetVersion(id), VERSION_MASK);
+    EXPECT_TRUE(IsValid(id));
+    EXPECT_FALSE(IsValid(static_cast<Id>(-1)));
+    EXPECT_EQ(INDEX_BITS + VERSION_BITS, sizeof(Id) * 8);
+
+    // The version wraps instead of overflowing into the index
+    auto next = NewId(3, GetVersion(NewId(3, VERSION_MASK)) + 1);
+    EXPECT_EQ(GetIndex(next), 3u);
+    EXPECT_EQ(GetVersion(next), 0u);
+}
+
+TEST(TestECS, ComponentMaskUsesSmallestWord)
+{
+    static_assert(sizeof(ecs::BitMask<8>) == 1);
+    static_assert(sizeof(ecs::BitMask<32>) == 4);
+    static_assert(sizeof(ecs::BitMask<64>) == 8);
+
+    ecs::BitMask<32> mask;
+    mask.set(0).set(5).set(31);
+    EXPECT_EQ(mask.count(), 3u);
+    EXPECT_TRUE(mask.test(31));
+    EXPECT_FALSE(mask.test(30));
+    EXPECT_EQ(mask & ecs::BitMask<32>(1ull << 5), ecs::BitMask<32>(1ull << 5));
+    mask.reset(5);
+    EXPECT_FALSE(mask.test(5));
+    mask.reset();
+    EXPECT_TRUE(mask.none());
+}
+
+TEST(TestECS, ChangedSinceSkipsUnchanged)
+{
+    ecs::Scene scene;
+    std::vector<ecs::Entity::Id> ids;
+    for (auto i = 0; i < 10; i++) {
+        ids.push_back(scene.NewEntity());
+        scene.AddComponent<Position>(ids.back(), float(i), 0.0f);
+        scene.AddComponent<Velocity>(ids.back());
+    }
+    auto count = [](const ecs::SceneView<Position> &view) {
+        size_t n = 0;
+        for (auto id : view) {
+            (void)id;
+            n++;
+        }
+        return n;
+    };
+
+    // An untracked type doesn't filter
+    ecs::SceneView<Position> view(scene);
+    EXPECT_EQ(count(view.ChangedSince<Position>(1)), 10u);
+
+    scene.TrackChanges<Position>();
+    scene.NextTick();
+    scene.MarkChanged<Position>(ids[3]);
+    scene.MarkChanged<Position>(ids[8]);
+    scene.MarkChanged<Velocity>(ids[5]);
+
+    // Removing and sorting rows keep the ticks of the remaining ones
+    scene.RemoveEntity(ids[0]);
+    scene.Group<Position, Velocity>();
+
+    std::vector<ecs::Entity::Id> changed;
+    auto since = ecs::SceneView<Position, Velocity>(scene).ChangedSince<Position>(scene.GetTick());
+    since.Each([&](ecs::Entity::Id id, Position &, Velocity &) {
+        changed.push_back(id);
+    });
+    std::sort(changed.begin(), changed.end());
+    EXPECT_EQ(changed, (std::vector<ecs::Entity::Id>{ ids[3], ids[8] }));
+    std::vector<ecs::Entity::Id> iterated;
+    for (auto id : since) {
+        iterated.push_back(id);
+    }
+    std::sort(iterated.begin(), iterated.end());
+    EXPECT_EQ(iterated, changed);
+
+    // Components added since then changed at their tick
+    auto id = scene.NewEntity();
+    scene.AddComponent<Position>(id);
+    EXPECT_EQ(count(view.ChangedSince<Position>(scene.GetTick())), 3u);
+    EXPECT_EQ(count(view.ChangedSince<Position>(0)), 10u);
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "Integrator.h"
+
+using steering::component::Move;
+using steering::component::SteeringForce;
+using steering::component::Transform;
+
+TEST(TestIntegrator, TruncatesForceAndSpeed)
+{
+    Transform t(glm::vec2(0.0f, 0.0f), glm::vec2(0.0f, -1.0f), glm::vec2(1.0f, 1.0f));
+    Move m(glm::vec2(0.0f, 0.0f), 1.0f, 5.0f, 10.0f);
+
+    steering::integrator::Integrate(t, m, glm::vec2(100.0f, 0.0f), 1.0f);
+    EXPECT_NEAR(m.velocity.x, 5.0f, 1e-5);
+    EXPECT_NEAR(m.velocity.y, 0.0f, 1e-5);
+    EXPECT_NEAR(t.position.x, 5.0f, 1e-5);
+    EXPECT_NEAR(t.rotation.x, 1.0f, 1e-5);
+    EXPECT_NEAR(t.rotation.y, 0.0f, 1e-5);
+}
+
+TEST(TestIntegrator, RestSpeedKeepsPosition)
+{
+    Transform t(glm::vec2(1.0f, 2.0f), glm::vec2(0.0f, -1.0f), glm::vec2(1.0f, 1.0f));
+    Move m(glm::vec2(0.0f, 0.0f), 1.0f, 100.0f, 100.0f);
+
+    steering::integrator::Integrate(t, m, glm::vec2(5.0f, 0.0f), 1.0f, 10.0f);
+    EXPECT_NEAR(m.velocity.x, 5.0f, 1e-5);
+    EXPECT_EQ(t.position.x, 1.0f);
+    EXPECT_EQ(t.position.y, 2.0f);
+    EXPECT_EQ(t.rotation.y, -1.0f);
+}
+
+TEST(TestIntegrator, AccumulateTruncatesRunningSum)
+{
+    SteeringForce sf;
+    EXPECT_TRUE(steering::integrator::Accumulate(sf, glm::vec2(6.0f, 0.0f), 1.0f, 10.0f));
+    EXPECT_NEAR(sf.force.x, 6.0f, 1e-5);
+
+    // Only the remaining budget of the later force is added.
+    EXPECT_TRUE(steering::integrator::Accumulate(sf, glm::vec2(0.0f, 10.0f), 0.5f, 10.0f));
+    EXPECT_NEAR(sf.force.x, 6.0f, 1e-5);
+    EXPECT_NEAR(sf.force.y, 4.0f, 1e-5);
+
+    SteeringForce full;
+    full.force = glm::vec2(10.0f, 0.0f);
+    EXPECT_FALSE(steering::integrator::Accumulate(full, glm::vec2(0.0f, 10.0f), 1.0f, 10.0f));
+    EXPECT_EQ(full.force.y, 0.0f);
+}
+
+TEST(TestIntegrator, BatchMatchesScalar)
+{
+    const size_t count = 37;
+    std::vector<Transform> ts, expectT;
+    std::vector<Move> ms, expectM;
+    std::vector<SteeringForce> forces;
+    for (size_t i = 0; i < count; i++) {
+        auto f = static_cast<float>(i);
+        ts.emplace_back(glm::vec2(f, -f), glm::vec2(0.0f, -1.0f), glm::vec2(1.0f, 1.0f));
+        ms.emplace_back(glm::vec2(f - 18.0f, 3.0f), 1.0f + f * 0.1f, 50.0f + f, 20.0f + f * 3.0f);
+        forces.emplace_back();
+        forces.back().force = glm::vec2(40.0f - f * 4.0f, f * 2.0f - 30.0f);
+        forces.back().rest = i % 5 == 0 ? 1000.0f : 0.0f;
+    }
+    expectT = ts;
+    expectM = ms;
+    for (size_t i = 0; i < count; i++) {
+        steering::integrator::Integrate(expectT[i], expectM[i], forces[i].force, 0.016f, forces[i].rest);
+    }
+
+    steering::integrator::IntegrateRows(ts.data(), ms.data(), forces.data(), count, 0.016f);
+    for (size_t i = 0; i < count; i++) {
+        EXPECT_NEAR(ms[i].velocity.x, expectM[i].velocity.x, 1e-3);
+        EXPECT_NEAR(ms[i].velocity.y, expectM[i].velocity.y, 1e-3);
+        EXPECT_NEAR(ts[i].position.x, expectT[i].position.x, 1e-3);
+        EXPECT_NEAR(ts[i].position.y, expectT[i].position.y, 1e-3);
+        EXPECT_NEAR(ts[i].rotation.x, expectT[i].rotation.x, 1e-3);
+        EXPECT_NEAR(ts[i].rotation.y, expectT[i].rotation.y, 1e-3);
+    }
+}
+
+TEST(TestIntegrator, RowsMarkMovedAgents)
+{
+    std::vector<Transform> ts(3, Transform(glm::vec2(1.0f), glm::vec2(0.0f, -1.0f), glm::vec2(1.0f)));
+    std::vector<Move> ms(3, Move(glm::vec2(0.0f), 1.0f, 50.0f, 20.0f));
+    std::vector<SteeringForce> forces(3);
+    ms[0].velocity = glm::vec2(10.0f, 0.0f);
+    forces[2].force = glm::vec2(0.0f, 5.0f);
+    forces[1].force = glm::vec2(5.0f, 0.0f);
+    forces[1].rest = 10.0f;
+    std::vector<uint32_t> ticks{ 1, 1, 1 };
+    std::vector<uint32_t> moveTicks{ 1, 1, 1 };
+
+    // The second agent speeds up below its rest speed, so it keeps its position
+    steering::integrator::IntegrateRows(ts.data(), ms.data(), forces.data(), 3, 0.016f, ticks.data(), 7, moveTicks.data());
+    EXPECT_EQ(ticks, (std::vector<uint32_t>{ 7, 1, 7 }));
+    EXPECT_EQ(moveTicks, (std::vector<uint32_t>{ 1, 7, 7 }));
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <ECS.h>
+
+#include "Lod.h"
+
+using steering::component::SteeringForce;
+using steering::component::Transform;
+
+TEST(TestLod, PeriodDoublesWithDistance)
+{
+    steering::lod::Config config;
+    EXPECT_EQ(steering::lod::Period(config, 1e6f), 1u);
+
+    config.near = 100.0f;
+    config.levels = 3;
+    EXPECT_EQ(steering::lod::Period(config, 0.0f), 1u);
+    EXPECT_EQ(steering::lod::Period(config, 99.0f), 1u);
+    EXPECT_EQ(steering::lod::Period(config, 100.0f), 2u);
+    EXPECT_EQ(steering::lod::Period(config, 250.0f), 4u);
+    EXPECT_EQ(steering::lod::Period(config, 1e6f), 4u);
+}
+
+TEST(TestLod, ScheduleSpreadsAgentsOverTicks)
+{
+    ecs::Scene scene;
+    scene.TrackChanges<SteeringForce>();
+    std::vector<ecs::Entity::Id> ids;
+    for (auto i = 0; i < 64; i++) {
+        ids.push_back(scene.NewEntity());
+        auto x = i < 16 ? 0.0f : 1000.0f;
+        scene.AddComponent<Transform>(ids.back(), glm::vec2(x, 0.0f), glm::vec2(0.0f, -1.0f), glm::vec2(1.0f));
+        scene.AddComponent<SteeringForce>(ids.back());
+    }
+    steering::lod::Config config;
+    config.near = 100.0f;
+    config.levels = 3;
+    auto metric = [](ecs::Entity::Id, const Transform &t) {
+        return t.position.x;
+    };
+
+    std::vector<int> updates(ids.size());
+    for (auto tick = 0; tick < 16; tick++) {
+        scene.NextTick();
+        steering::lod::Schedule(config, metric, scene);
+        size_t due = 0;
+        steering::lod::Due<Transform, SteeringForce>(scene).Each([&](
+                ecs::Entity::Id id, Transform &, SteeringForce &sf) {
+            updates[ecs::Entity::GetIndex(id)]++;
+            sf.force = glm::vec2(1.0f, 0.0f);
+            due++;
+        });
+        // After the first tick, every tick updates the near agents and a
+        // quarter of the far ones
+        if (0 < tick) {
+            EXPECT_EQ(due, 16u + 12u);
+        }
+    }
+    for (size_t i = 0; i < ids.size(); i++) {
+        EXPECT_EQ(updates[i], i < 16 ? 16 : (i % 4 == 3 ? 4 : 5)) << i;
+    }
+
+    // The far agents hold their force between updates
+    scene.NextTick();
+    steering::lod::Schedule(config, metric, scene);
+    for (size_t i = 16; i < ids.size(); i++) {
+        auto sf = scene.GetComponent<SteeringForce>(ids[i]);
+        EXPECT_EQ(sf->period, 4u);
+        auto due = steering::lod::IsDue(scene.GetTick(), ids[i], 4);
+        EXPECT_EQ(sf->force.x, due ? 0.0f : 1.0f);
+    }
+}
+
+TEST(TestLod, ScheduleHoldsSettledAgents)
+{
+    ecs::Scene scene;
+    scene.TrackChanges<SteeringForce>();
+    auto id = scene.NewEntity();
+    scene.AddComponent<Transform>(id, glm::vec2(0.0f), glm::vec2(0.0f, -1.0f), glm::vec2(1.0f));
+    scene.AddComponent<SteeringForce>(id);
+    steering::lod::Config config;
+    auto metric = [](ecs::Entity::Id, const Transform &) {
+        return 0.0f;
+    };
+    auto settled = false;
+    auto hold = [&](ecs::Entity::Id) {
+        return settled;
+    };
+    auto due = [&]() {
+        size_t n = 0;
+        steering::lod::Due<SteeringForce>(scene).Each([&](SteeringForce &sf) {
+            sf.force = glm::vec2(1.0f, 0.0f);
+            sf.rest = 10.0f;
+            n++;
+        });
+        return n;
+    };
+
+    scene.NextTick();
+    steering::lod::Schedule(config, metric, hold, scene);
+    EXPECT_EQ(due(), 1u);
+    EXPECT_FALSE(scene.GetComponent<SteeringForce>(id)->held);
+
+    // A settled agent is updated once more, then keeps its force
+    settled = true;
+    for (auto updates : { 1u, 0u, 0u }) {
+        scene.NextTick();
+        steering::lod::Schedule(config, metric, hold, scene);
+        EXPECT_EQ(due(), updates);
+        auto sf = scene.GetComponent<SteeringForce>(id);
+        EXPECT_TRUE(sf->held);
+        EXPECT_EQ(sf->force, glm::vec2(1.0f, 0.0f));
+        EXPECT_EQ(sf->rest, 10.0f);
+    }
+
+    // It is updated again as soon as it isn't settled
+    settled = false;
+    scene.NextTick();
+    steering::lod::Schedule(config, metric, hold, scene);
+    EXPECT_FALSE(scene.GetComponent<SteeringForce>(id)->held);
+    EXPECT_EQ(scene.GetComponent<SteeringForce>(id)->force, glm::vec2(0.0f));
+    EXPECT_EQ(due(), 1u);
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "Obstacles.h"
+
+using steering::component::Move;
+using steering::component::ObstacleAvoidance;
+using steering::component::Transform;
+using steering::component::WallAvoidance;
+using steering::spatial::Box;
+
+TEST(TestObstacles, BvhQueryMatchesBruteForce)
+{
+    std::mt19937 engine(5);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<Box> boxes;
+    for (auto i = 0; i < 1000; i++) {
+        auto min = glm::vec2(unit(engine), unit(engine)) * 1000.0f;
+        boxes.push_back(Box{ min, min + glm::vec2(unit(engine), unit(engine)) * 40.0f });
+    }
+    steering::spatial::Bvh bvh(boxes);
+    EXPECT_EQ(bvh.Size(), boxes.size());
+
+    for (auto q = 0; q < 100; q++) {
+        auto min = glm::vec2(unit(engine), unit(engine)) * 1000.0f;
+        auto query = Box{ min, min + glm::vec2(unit(engine), unit(engine)) * 100.0f };
+        std::vector<uint32_t> found, expected;
+        bvh.Query(query, [&](uint32_t i) { found.push_back(i); });
+        for (uint32_t i = 0; i < boxes.size(); i++) {
+            if (boxes[i].Overlaps(query)) {
+                expected.push_back(i);
+            }
+        }
+        std::sort(found.begin(), found.end());
+        EXPECT_EQ(found, expected);
+    }
+
+    steering::spatial::Bvh empty(std::vector<Box>{});
+    empty.Query(Box{ glm::vec2(0.0f), glm::vec2(1000.0f) }, [&](uint32_t) { FAIL(); });
+}
+
+TEST(TestObstacles, AvoidsObstacleAhead)
+{
+    steering::spatial::Obstacles obstacles({ { glm::vec2(50.0f, 5.0f), 10.0f } }, {});
+    // Heading along +x: the obstacle is ahead, slightly to the +y side
+    Transform t(glm::vec2(0.0f), glm::vec2(1.0f, 0.0f), glm::vec2(1.0f));
+    Move m(glm::vec2(10.0f, 0.0f), 1.0f, 10.0f, 20.0f);
+    ObstacleAvoidance oa(5.0f, 40.0f);
+
+    auto force = steering::spatial::AvoidObstacles(obstacles, t, m, oa);
+    EXPECT_LT(force.y, 0.0f);
+    EXPECT_LT(force.x, 0.0f);
+
+    // Behind the agent or out of the box sideways, it's ignored
+    t.rotation = glm::vec2(-1.0f, 0.0f);
+    EXPECT_EQ(steering::spatial::AvoidObstacles(obstacles, t, m, oa), glm::vec2(0.0f));
+    t.rotation = glm::vec2(1.0f, 0.0f);
+    t.position.y = -20.0f;
+    EXPECT_EQ(steering::spatial::AvoidObstacles(obstacles, t, m, oa), glm::vec2(0.0f));
+}
+
+TEST(TestObstacles, FeelersPushAwayFromWall)
+{
+    steering::spatial::Obstacles obstacles({}, {
+        steering::spatial::Wall(glm::vec2(20.0f, -100.0f), glm::vec2(20.0f, 100.0f))
+    });
+    Transform t(glm::vec2(0.0f), glm::vec2(1.0f, 0.0f), glm::vec2(1.0f));
+    Move m(glm::vec2(10.0f, 0.0f), 1.0f, 10.0f, 20.0f);
+    WallAvoidance wa(40.0f);
+
+    // The front feeler reaches 20 past the wall, the side ones 14.14 - 20 short of it
+    auto force = steering::spatial::AvoidWalls(obstacles, t, m, wa);
+    EXPECT_NEAR(force.x, -0.5f * m.maxForce, 1e-4);
+    EXPECT_NEAR(force.y, 0.0f, 1e-4);
+
+    // From the other side, the wall pushes the other way
+    t.position.x = 40.0f;
+    t.rotation = glm::vec2(-1.0f, 0.0f);
+    force = steering::spatial::AvoidWalls(obstacles, t, m, wa);
+    EXPECT_NEAR(force.x, 0.5f * m.maxForce, 1e-4);
+
+    t.position.x = -100.0f;
+    t.rotation = glm::vec2(1.0f, 0.0f);
+    EXPECT_EQ(steering::spatial::AvoidWalls(obstacles, t, m, wa), glm::vec2(0.0f));
+}
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "Profiler.h"
+#include "ThreadPool.h"
+
+TEST(TestProfiler, CollectsScopesFromEveryThread)
+{
+    steering::Profiler profiler;
+    steering::ThreadPool pool(3);
+    std::atomic<int> done{ 0 };
+    for (auto i = 0; i < 100; i++) {
+        pool.Submit([&]() {
+            steering::Profiler::Scope scope(&profiler, "task");
+            done++;
+        });
+    }
+    pool.Wait([&]() { return done == 100; });
+    {
+        steering::Profiler::Scope scope(&profiler, "main");
+    }
+    profiler.EndFrame();
+
+    EXPECT_EQ(profiler.GetNames(), (std::vector<std::string>{ "main", "task" }));
+    EXPECT_LT(0.0, profiler.Percentile("task", 50.0));
+    EXPECT_EQ(0.0, profiler.Percentile("missing", 50.0));
+}
+
+TEST(TestProfiler, PercentilesOverRollingWindow)
+{
+    steering::Profiler profiler;
+    // One event of n ms per frame, the older frames fall out of the window
+    for (uint64_t n = 1; n <= 2 * steering::Profiler::WINDOW; n++) {
+        profiler.Record("system", 0, n * 1000000);
+        profiler.EndFrame();
+    }
+    auto first = steering::Profiler::WINDOW + 1.0;
+    auto last = 2.0 * steering::Profiler::WINDOW;
+    EXPECT_DOUBLE_EQ(profiler.Percentile("system", 0.0), first);
+    EXPECT_DOUBLE_EQ(profiler.Percentile("system", 100.0), last);
+    EXPECT_NEAR(profiler.Percentile("system", 50.0), (first + last) / 2.0, 1.0);
+}
+
+TEST(TestProfiler, SparseNamesKeepTheirLastSamples)
+{
+    steering::Profiler profiler;
+    // A name recorded every third frame: its window holds its own last
+    // WINDOW samples, whatever the frame count
+    for (uint64_t n = 1; n <= 3 * steering::Profiler::WINDOW + 1; n++) {
+        if (n % 3 == 0) {
+            profiler.Record("sparse", 0, n * 1000000);
+        }
+        profiler.EndFrame();
+    }
+    EXPECT_DOUBLE_EQ(profiler.Percentile("sparse", 0.0), 3.0);
+    EXPECT_DOUBLE_EQ(profiler.Percentile("sparse", 100.0), 3.0 * steering::Profiler::WINDOW);
+
+    for (uint64_t n = 1; n <= steering::Profiler::WINDOW / 2; n++) {
+        profiler.Record("sparse", 0, 1000000000);
+        profiler.EndFrame();
+        profiler.EndFrame();
+    }
+    EXPECT_DOUBLE_EQ(profiler.Percentile("sparse", 0.0), 3.0 * (steering::Profiler::WINDOW / 2 + 1));
+}
+
+TEST(TestProfiler, WritesChromeTrace)
+{
+    steering::Profiler profiler;
+    profiler.Capture(true);
+    profiler.Record("update::Integrate", 2000, 3000);
+    profiler.EndFrame();
+
+    auto path = testing::TempDir() + "trace.json";
+    ASSERT_TRUE(profiler.WriteChromeTrace(path));
+    std::ifstream in(path);
+    std::stringstream trace;
+    trace << in.rdbuf();
+    EXPECT_NE(trace.str().find("\"name\":\"update::Integrate\""), std::string::npos);
+    EXPECT_NE(trace.str().find("\"ts\":2,\"dur\":3"), std::string::npos);
+}
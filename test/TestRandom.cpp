@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <set>
+#include <vector>
+
+#include "Random.h"
+
+TEST(TestRandom, StreamsAreReproducible)
+{
+    using namespace steering::random;
+    auto key = Key(ecs::Entity::NewId(7, 1));
+    EXPECT_EQ(key, Key(ecs::Entity::NewId(7, 1)));
+    EXPECT_NE(key, Key(ecs::Entity::NewId(7, 2)));
+    EXPECT_NE(key, Key(ecs::Entity::NewId(7, 1), 1));
+
+    // Numbers don't depend on the order they are generated in
+    Stream stream{ key, 0 };
+    std::vector<uint32_t> numbers;
+    for (uint32_t n = 0; n < 100; n++) {
+        numbers.push_back(stream.Next());
+    }
+    EXPECT_EQ(stream.counter, 100u);
+    for (uint32_t n = 100; n-- > 0;) {
+        EXPECT_EQ(At(key, n), numbers[n]);
+    }
+    EXPECT_EQ(std::set<uint32_t>(numbers.begin(), numbers.end()).size(), numbers.size());
+}
+
+TEST(TestRandom, ClampedIsInRange)
+{
+    using namespace steering::random;
+    EXPECT_EQ(Clamped(0u), -1.0f);
+    EXPECT_LT(Clamped(0xffffffffu), 1.0f);
+
+    Stream stream{ Key(3), 0 };
+    auto sum = 0.0;
+    for (auto n = 0; n < 10000; n++) {
+        auto x = stream.NextClamped();
+        EXPECT_GE(x, -1.0f);
+        EXPECT_LT(x, 1.0f);
+        sum += x;
+    }
+    EXPECT_NEAR(sum / 10000, 0.0, 0.05);
+}
+
+TEST(TestRandom, JitterMatchesStreams)
+{
+    using namespace steering::random;
+    std::vector<uint32_t> keys;
+    for (ecs::Entity::Index i = 0; i < 37; i++) {
+        keys.push_back(Key(ecs::Entity::NewId(i, 0)));
+    }
+    std::vector<float> x(keys.size()), y(keys.size());
+    Jitter(keys.size(), keys.data(), 10, x.data(), y.data());
+
+    for (size_t i = 0; i < keys.size(); i++) {
+        Stream stream{ keys[i], 10 };
+        EXPECT_EQ(x[i], stream.NextClamped());
+        EXPECT_EQ(y[i], stream.NextClamped());
+    }
+}
@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "Raster.h"
+
+TEST(TestRaster, CircleOutlineIsOnRadius)
+{
+    for (auto r = 0; r <= 40; r++) {
+        auto points = steering::raster::CircleOutline(r);
+        ASSERT_FALSE(points.empty());
+        for (auto p : points) {
+            auto d = std::sqrt(static_cast<float>(p.x * p.x + p.y * p.y));
+            EXPECT_NEAR(d, static_cast<float>(r), 0.5f) << "radius " << r;
+        }
+    }
+    EXPECT_EQ(steering::raster::CircleOutline(0).size(), 1u);
+    EXPECT_EQ(steering::raster::CircleOutline(1).size(), 4u);
+}
+
+TEST(TestRaster, CircleOutlineHasNoDuplicates)
+{
+    auto points = steering::raster::CircleOutline(25);
+    std::vector<std::pair<int, int>> pairs;
+    for (auto p : points) {
+        pairs.emplace_back(p.x, p.y);
+    }
+    std::sort(pairs.begin(), pairs.end());
+    EXPECT_EQ(std::adjacent_find(pairs.begin(), pairs.end()), pairs.end());
+
+    // Symmetric in both axes
+    for (auto p : pairs) {
+        EXPECT_TRUE(std::binary_search(pairs.begin(), pairs.end(), std::make_pair(-p.first, p.second)));
+        EXPECT_TRUE(std::binary_search(pairs.begin(), pairs.end(), std::make_pair(p.first, -p.second)));
+    }
+}
+
+TEST(TestRaster, CircleTableCachesPerRadius)
+{
+    steering::raster::CircleTable table;
+    auto &a = table.Get(10);
+    table.Get(11);
+    table.Get(12);
+    EXPECT_EQ(&a, &table.Get(10));
+    EXPECT_EQ(a.size(), steering::raster::CircleOutline(10).size());
+}
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "Parallel.h"
+#include "Scheduler.h"
+#include "ThreadPool.h"
+
+namespace {
+
+struct A {};
+struct B {};
+struct C {};
+
+struct Value {
+    int value;
+};
+
+}  // namespace
+
+TEST(TestScheduler, PoolRunsAllTasks)
+{
+    steering::ThreadPool pool(3);
+    std::atomic<int> count{ 0 };
+    for (auto i = 0; i < 1000; i++) {
+        pool.Submit([&]() { count++; });
+    }
+    pool.Wait([&]() { return count == 1000; });
+    EXPECT_EQ(count, 1000);
+}
+
+TEST(TestScheduler, PoolWithoutWorkersRunsOnWaiter)
+{
+    steering::ThreadPool pool(0);
+    auto count = 0;
+    pool.Submit([&]() { count++; });
+    pool.Submit([&]() { count++; });
+    pool.Wait([&]() { return count == 2; });
+    EXPECT_EQ(count, 2);
+}
+
+TEST(TestScheduler, ConflictingSystemsKeepOrder)
+{
+    steering::ThreadPool pool(4);
+    steering::Scheduler scheduler(pool);
+
+    std::mutex mutex;
+    std::vector<int> order;
+    auto log = [&](int n) {
+        std::lock_guard<std::mutex> lock(mutex);
+        order.push_back(n);
+    };
+    scheduler.Add("write A", steering::Reads<>(), steering::Writes<A>(), [&]() { log(0); });
+    scheduler.Add("read A",  steering::Reads<A>(), steering::Writes<B>(), [&]() { log(1); });
+    scheduler.Add("write B", steering::Reads<>(), steering::Writes<B>(), [&]() { log(2); });
+    scheduler.Add("read C",  steering::Reads<C>(), steering::Writes<>(), [&]() { log(3); });
+
+    EXPECT_EQ(scheduler.GetDependents(0), std::vector<size_t>{ 1 });
+    EXPECT_EQ(scheduler.GetDependents(1), std::vector<size_t>{ 2 });
+    EXPECT_TRUE(scheduler.GetDependents(3).empty());
+
+    for (auto run = 0; run < 100; run++) {
+        order.clear();
+        scheduler.Run();
+        ASSERT_EQ(order.size(), 4u);
+        auto at = [&](int n) { return std::find(order.begin(), order.end(), n) - order.begin(); };
+        EXPECT_LT(at(0), at(1));
+        EXPECT_LT(at(1), at(2));
+    }
+}
+
+TEST(TestScheduler, SceneAccessRunsAlone)
+{
+    steering::ThreadPool pool(2);
+    steering::Scheduler scheduler(pool);
+    scheduler.Add("read A", steering::Reads<A>(), steering::Writes<>(), []() {});
+    scheduler.Add("spawn", steering::Reads<>(), steering::Writes<ecs::Scene>(), []() {});
+    scheduler.Add("read B", steering::Reads<B>(), steering::Writes<>(), []() {});
+
+    EXPECT_EQ(scheduler.GetDependents(0), std::vector<size_t>{ 1 });
+    EXPECT_EQ(scheduler.GetDependents(1), std::vector<size_t>{ 2 });
+    scheduler.Run();
+}
+
+TEST(TestScheduler, ParallelEachVisitsEveryEntityOnce)
+{
+    ecs::Scene scene;
+    for (auto i = 0; i < 5000; i++) {
+        auto id = scene.NewEntity();
+        if (i % 3 != 0) {
+            scene.AddComponent<Value>(id, Value{ 0 });
+        }
+    }
+
+    steering::ThreadPool pool(3);
+    ecs::SceneView<Value> view(scene);
+    steering::ParallelEach(pool, view, [](Value &v) { v.value++; }, 64);
+
+    auto count = 0;
+    view.Each([&](Value &v) {
+        EXPECT_EQ(v.value, 1);
+        count++;
+    });
+    EXPECT_EQ(count, 3333);
+}
+
+TEST(TestScheduler, FirstTouchKeepsArenaContents)
+{
+    ecs::Arena arena(1 << 22);
+    ecs::Scene scene(&arena);
+    auto id = scene.NewEntity();
+    scene.AddComponent<Value>(id, Value{ 7 });
+
+    steering::ThreadPool pool(3);
+    steering::FirstTouch(pool, arena, arena.GetCapacity());
+    EXPECT_EQ(scene.GetComponent<Value>(id)->value, 7);
+}
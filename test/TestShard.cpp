@@ -0,0 +1,218 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <ECS.h>
+
+#include "Component.h"
+#include "Shard.h"
+
+namespace {
+
+using namespace steering;
+
+typedef Shard<component::Transform,
+              component::Move,
+              component::SteeringForce,
+              component::Seek,
+              component::Pursuit> TestShard;
+
+shard::Layout TwoShards() {
+    shard::Layout layout;
+    layout.world = glm::vec2(200.0f, 100.0f);
+    layout.columns = 2;
+    layout.rows = 1;
+    layout.halo = 10.0f;
+    return layout;
+}
+
+ecs::Entity::Id NewAgent(ecs::Scene &scene, TestShard &shard, glm::vec2 position) {
+    auto id = scene.NewEntity();
+    scene.AddComponent<component::Transform>(id, position, glm::vec2(0.0f, -1.0f), glm::vec2(1.0f));
+    scene.AddComponent<component::Move>(id, glm::vec2(1.0f, 0.0f), 1.0f, 10.0f, 10.0f);
+    scene.AddComponent<component::SteeringForce>(id);
+    shard.Adopt(scene, id);
+    return id;
+}
+
+/**
+ * Run the exchange of both shards at once, as their processes would.
+ */
+void ExchangeBoth(TestShard &a, ecs::Scene &sa, TestShard &b, ecs::Scene &sb) {
+    bool ok = false;
+    std::thread other([&]() { ok = b.Exchange(sb); });
+    EXPECT_TRUE(a.Exchange(sa));
+    other.join();
+    EXPECT_TRUE(ok);
+}
+
+}  // namespace
+
+TEST(TestShard, LayoutWrapsAroundTheWorld)
+{
+    shard::Layout layout;
+    layout.world = glm::vec2(300.0f, 300.0f);
+    layout.columns = 3;
+    layout.rows = 3;
+    EXPECT_EQ(layout.Count(), 9u);
+    EXPECT_EQ(layout.ShardOf(glm::vec2(150.0f, 150.0f)), 4u);
+    EXPECT_EQ(layout.ShardOf(glm::vec2(-1.0f, 50.0f)), 2u);
+    EXPECT_EQ(layout.ShardOf(glm::vec2(50.0f, 301.0f)), 0u);
+    EXPECT_EQ(layout.Neighbors(0), (std::vector<uint32_t>{ 1, 2, 3, 4, 5, 6, 7, 8 }));
+    EXPECT_EQ(TwoShards().Neighbors(0), std::vector<uint32_t>{ 1 });
+}
+
+TEST(TestShard, MigratesAndMirrorsBorderAgents)
+{
+    auto layout = TwoShards();
+    shard::Loopback loopback(layout.Count());
+    shard::LoopbackTransport ta(loopback, 0), tb(loopback, 1);
+    TestShard a(layout, 0, ta), b(layout, 1, tb);
+    ecs::Scene sa, sb;
+
+    // One agent crossed into shard 1, one is within the halo of its border,
+    // one pursues the latter and one is far from any border
+    auto crossed = NewAgent(sa, a, glm::vec2(105.0f, 50.0f));
+    sa.AddComponent<component::Seek>(crossed);
+    auto border = NewAgent(sa, a, glm::vec2(95.0f, 50.0f));
+    auto pursuer = NewAgent(sa, a, glm::vec2(101.0f, 20.0f));
+    sa.AddComponent<component::Pursuit>(pursuer, border);
+    NewAgent(sa, a, glm::vec2(50.0f, 50.0f));
+    auto handle = a.GetHandle(sa, crossed);
+
+    ExchangeBoth(a, sa, b, sb);
+    EXPECT_EQ(b.GetArrived(), 2u);
+    auto arrived = b.Resolve(handle);
+    ASSERT_TRUE(sb.IsAlive(arrived));
+    EXPECT_TRUE(sb.HasComponent<component::Seek>(arrived));
+    EXPECT_FALSE(sb.HasComponent<component::Ghost>(arrived));
+    EXPECT_EQ(sb.GetComponent<component::Transform>(arrived)->position.x, 105.0f);
+
+    // The pursuer's evader is now the ghost of the border agent
+    auto ghost = b.Resolve(a.GetHandle(sa, border));
+    ASSERT_TRUE(sb.IsAlive(ghost));
+    EXPECT_TRUE(sb.HasComponent<component::Ghost>(ghost));
+    EXPECT_FALSE(sb.HasComponent<component::SteeringForce>(ghost));
+    EXPECT_EQ(sb.GetComponent<component::Pursuit>(b.Resolve(a.GetHandle(sa, pursuer)))->evaderId, ghost);
+
+    // The migrants stay behind as ghosts, until shard 1 stops mirroring them
+    EXPECT_TRUE(sa.HasComponent<component::Ghost>(crossed));
+    EXPECT_FALSE(sa.HasComponent<component::Seek>(crossed));
+    sb.GetComponent<component::Transform>(arrived)->position.x = 150.0f;
+    ExchangeBoth(a, sa, b, sb);
+    EXPECT_FALSE(sa.IsAlive(crossed));
+    EXPECT_TRUE(sa.IsAlive(a.Resolve(a.GetHandle(sa, pursuer))));
+    EXPECT_EQ(ecs::SceneView<component::Ghost>(sa).Size(), 1u);  // the pursuer
+    EXPECT_EQ(ecs::SceneView<component::Ghost>(sb).Size(), 1u);  // the border agent
+}
+
+TEST(TestShard, LeavesGhostsWithoutUnlistedComponents)
+{
+    // SteeringForce and Color aren't sent with the migrants
+    typedef Shard<component::Transform, component::Move, component::Seek> SeekShard;
+    auto layout = TwoShards();
+    shard::Loopback loopback(layout.Count());
+    shard::LoopbackTransport ta(loopback, 0), tb(loopback, 1);
+    SeekShard a(layout, 0, ta), b(layout, 1, tb);
+    ecs::Scene sa, sb;
+
+    auto crossed = sa.NewEntity();
+    sa.AddComponent<component::Transform>(crossed, glm::vec2(105.0f, 50.0f), glm::vec2(0.0f, -1.0f), glm::vec2(1.0f));
+    sa.AddComponent<component::Move>(crossed, glm::vec2(1.0f, 0.0f), 1.0f, 10.0f, 10.0f);
+    sa.AddComponent<component::SteeringForce>(crossed);
+    sa.AddComponent<component::Seek>(crossed);
+    sa.AddComponent<component::Color>(crossed, 255, 255, 255, 255);
+    a.Adopt(sa, crossed);
+
+    bool ok = false;
+    std::thread other([&]() { ok = b.Exchange(sb); });
+    EXPECT_TRUE(a.Exchange(sa));
+    other.join();
+    EXPECT_TRUE(ok);
+
+    // The ghost left behind has what a received one has, and isn't steered
+    auto mask = sa.GetEntities()[ecs::Entity::GetIndex(crossed)].mask_;
+    EXPECT_EQ(mask, (ecs::Component::MaskOf<component::Transform,
+                                            component::Move,
+                                            component::Global,
+                                            component::Ghost>()));
+    EXPECT_EQ(ecs::SceneView<component::SteeringForce>(sa).Size(), 0u);
+    auto arrived = b.Resolve(a.GetHandle(sa, crossed));
+    EXPECT_TRUE(sb.HasComponent<component::Seek>(arrived));
+    EXPECT_FALSE(sb.HasComponent<component::SteeringForce>(arrived));
+}
+
+TEST(TestShard, KeepsAgentsThatJumpPastTheNeighbors)
+{
+    shard::Layout layout;
+    layout.world = glm::vec2(400.0f, 100.0f);
+    layout.columns = 4;
+    layout.rows = 1;
+    layout.halo = 10.0f;
+    ASSERT_EQ(layout.Neighbors(0), (std::vector<uint32_t>{ 1, 3 }));
+    shard::Loopback loopback(layout.Count());
+    std::vector<std::unique_ptr<shard::LoopbackTransport>> transports;
+    std::vector<std::unique_ptr<TestShard>> shards;
+    std::vector<ecs::Scene> scenes(layout.Count());
+    for (uint32_t i = 0; i < layout.Count(); i++) {
+        transports.push_back(std::make_unique<shard::LoopbackTransport>(loopback, i));
+        shards.push_back(std::make_unique<TestShard>(layout, i, *transports.back()));
+    }
+
+    // The agent of shard 0 jumped into shard 2, which isn't a neighbor
+    auto jumped = NewAgent(scenes[0], *shards[0], glm::vec2(250.0f, 50.0f));
+    EXPECT_THROW(shards[0]->Adopt(scenes[0], jumped), std::invalid_argument);
+
+    std::vector<char> ok(layout.Count(), false);
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < layout.Count(); i++) {
+        threads.emplace_back([&, i]() { ok[i] = shards[i]->Exchange(scenes[i]); });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    EXPECT_FALSE(ok[0]);
+    EXPECT_TRUE(ok[1] && ok[2] && ok[3]);
+    EXPECT_TRUE(scenes[0].IsAlive(jumped));
+    EXPECT_FALSE(scenes[0].HasComponent<component::Ghost>(jumped));
+    EXPECT_EQ(shards[2]->GetArrived(), 0u);
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+TEST(TestShard, SocketTransportExchangesLargeMessages)
+{
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    shard::SocketTransport ta({ -1, fds[0] });
+    shard::SocketTransport tb({ fds[1], -1 });
+
+    // Larger than the socket buffers, in both directions at once
+    std::vector<shard::Message> ia, ib;
+    std::vector<shard::Message> oa{ shard::Message(1 << 22, 1) };
+    std::vector<shard::Message> ob{ shard::Message(1 << 21, 2) };
+    bool ok = false;
+    std::thread other([&]() { ok = tb.Exchange({ 0 }, ob, ib); });
+    EXPECT_TRUE(ta.Exchange({ 1 }, oa, ia));
+    other.join();
+    EXPECT_TRUE(ok);
+    ASSERT_EQ(ia.size(), 1u);
+    ASSERT_EQ(ib.size(), 1u);
+    EXPECT_EQ(ia[0], ob[0]);
+    EXPECT_EQ(ib[0], oa[0]);
+
+    // Empty messages are framed too, and a missing peer fails
+    oa[0].clear();
+    ob[0].clear();
+    std::thread empty([&]() { ok = tb.Exchange({ 0 }, ob, ib); });
+    EXPECT_TRUE(ta.Exchange({ 1 }, oa, ia));
+    empty.join();
+    EXPECT_TRUE(ok);
+    EXPECT_TRUE(ia[0].empty());
+    EXPECT_FALSE(ta.Exchange({ 0 }, oa, ia));
+}
+#endif
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <ECS.h>
+
+#include "Component.h"
+#include "Spatial.h"
+
+using steering::component::Move;
+using steering::component::Transform;
+
+namespace {
+
+ecs::Entity::Id NewAgent(ecs::Scene &scene, glm::vec2 position) {
+    auto id = scene.NewEntity();
+    scene.AddComponent<Transform>(id, position, glm::vec2(0.0f, -1.0f), glm::vec2(1.0f, 1.0f));
+    scene.AddComponent<Move>(id, glm::vec2(0.0f, 0.0f), 1.0f, 1.0f, 1.0f);
+    return id;
+}
+
+std::vector<ecs::Entity::Id> Neighbors(const steering::spatial::Grid &grid,
+                                       glm::vec2 position, float radius) {
+    std::vector<ecs::Entity::Id> ids;
+    grid.Query(position, radius, [&](const steering::spatial::Entry *first,
+                                     const steering::spatial::Entry *last) {
+        for (auto e = first; e != last; e++) {
+            if (glm::length(grid.Delta(position, e->position)) <= radius) {
+                ids.push_back(e->id);
+            }
+        }
+    });
+    return ids;
+}
+
+}  // namespace
+
+TEST(TestSpatial, QueryFindsNeighbors)
+{
+    ecs::Scene scene;
+    auto a = NewAgent(scene, glm::vec2(100.0f, 100.0f));
+    auto b = NewAgent(scene, glm::vec2(120.0f, 100.0f));
+    NewAgent(scene, glm::vec2(300.0f, 300.0f));
+
+    steering::spatial::Grid grid(glm::vec2(1000.0f, 1000.0f), 50.0f);
+    grid.Build(scene);
+    EXPECT_EQ(grid.GetEntries().size(), 3u);
+
+    auto ids = Neighbors(grid, glm::vec2(100.0f, 100.0f), 30.0f);
+    ASSERT_EQ(ids.size(), 2u);
+    EXPECT_TRUE((ids[0] == a && ids[1] == b) || (ids[0] == b && ids[1] == a));
+}
+
+TEST(TestSpatial, QueryWrapsAround)
+{
+    ecs::Scene scene;
+    auto a = NewAgent(scene, glm::vec2(995.0f, 10.0f));
+    NewAgent(scene, glm::vec2(500.0f, 500.0f));
+
+    steering::spatial::Grid grid(glm::vec2(1000.0f, 1000.0f), 50.0f);
+    grid.Build(scene);
+
+    auto ids = Neighbors(grid, glm::vec2(5.0f, 990.0f), 30.0f);
+    ASSERT_EQ(ids.size(), 1u);
+    EXPECT_EQ(ids[0], a);
+
+    auto d = grid.Delta(glm::vec2(5.0f, 990.0f), glm::vec2(995.0f, 10.0f));
+    EXPECT_NEAR(d.x, -10.0f, 1e-3);
+    EXPECT_NEAR(d.y, 20.0f, 1e-3);
+}
+
+TEST(TestSpatial, QueryVisitsEachCellOnce)
+{
+    ecs::Scene scene;
+    NewAgent(scene, glm::vec2(10.0f, 10.0f));
+    NewAgent(scene, glm::vec2(90.0f, 90.0f));
+
+    steering::spatial::Grid grid(glm::vec2(100.0f, 100.0f), 50.0f);
+    grid.Build(scene);
+
+    auto ids = Neighbors(grid, glm::vec2(50.0f, 50.0f), 500.0f);
+    EXPECT_EQ(ids.size(), 2u);
+}
+
+TEST(TestSpatial, QueryBoxVisitsOverlappingCells)
+{
+    ecs::Scene scene;
+    auto a = NewAgent(scene, glm::vec2(120.0f, 130.0f));
+    auto b = NewAgent(scene, glm::vec2(240.0f, 20.0f));
+    NewAgent(scene, glm::vec2(700.0f, 700.0f));
+
+    steering::spatial::Grid grid(glm::vec2(1000.0f, 1000.0f), 50.0f);
+    grid.Build(scene);
+
+    std::vector<ecs::Entity::Id> ids;
+    grid.QueryBox(glm::vec2(100.0f, 0.0f), glm::vec2(249.0f, 149.0f), [&](
+            const steering::spatial::Entry *first,
+            const steering::spatial::Entry *last) {
+        for (auto e = first; e != last; e++) {
+            ids.push_back(e->id);
+        }
+    });
+    ASSERT_EQ(ids.size(), 2u);
+    EXPECT_TRUE((ids[0] == a && ids[1] == b) || (ids[0] == b && ids[1] == a));
+}
@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+
+#include <glm/glm.hpp>
+
+#include <ECS.h>
+
+#include "Component.h"
+#include "System.h"
+
+namespace {
+
+using namespace steering;
+
+ecs::Entity::Id NewAgent(ecs::Scene &scene, glm::vec2 position, glm::vec2 velocity) {
+    auto id = scene.NewEntity();
+    scene.AddComponent<component::Transform>(id, position, glm::vec2(1.0f, 0.0f), glm::vec2(1.0f));
+    scene.AddComponent<component::Move>(id, velocity, 1.0f, 10.0f, 10.0f);
+    scene.AddComponent<component::SteeringForce>(id);
+    return id;
+}
+
+}  // namespace
+
+TEST(TestSystem, PursuitAndEvadeReadLiveComponents)
+{
+    // Neither Transform nor Move is double buffered
+    ecs::Scene scene;
+    auto pursuer = NewAgent(scene, glm::vec2(0.0f), glm::vec2(0.0f));
+    auto evader = NewAgent(scene, glm::vec2(20.0f, 0.0f), glm::vec2(0.0f, 5.0f));
+    scene.GetComponent<component::Transform>(evader)->rotation = glm::vec2(0.0f, 1.0f);
+    scene.AddComponent<component::Pursuit>(pursuer, evader);
+    scene.AddComponent<component::Evade>(evader, pursuer, 100.0f);
+
+    behavior::Pursuit(scene);
+    behavior::Evade(scene);
+
+    // The pursuer heads for the evader, ahead of it along its velocity
+    auto pf = scene.GetComponent<component::SteeringForce>(pursuer)->force;
+    EXPECT_LT(0.0f, pf.x);
+    EXPECT_LT(0.0f, pf.y);
+
+    // The evader flees away from the pursuer
+    auto ef = scene.GetComponent<component::SteeringForce>(evader)->force;
+    EXPECT_LT(0.0f, ef.x);
+
+    // An agent without a target isn't steered
+    scene.RemoveEntity(evader);
+    scene.GetComponent<component::SteeringForce>(pursuer)->force = glm::vec2(0.0f);
+    behavior::Pursuit(scene);
+    EXPECT_EQ(scene.GetComponent<component::SteeringForce>(pursuer)->force, glm::vec2(0.0f));
+}
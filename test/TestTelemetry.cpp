@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <ECS.h>
+
+#include "Component.h"
+#include "Telemetry.h"
+
+using namespace steering;
+
+TEST(TestTelemetry, VarintRoundTrips)
+{
+    std::vector<uint8_t> bytes;
+    std::vector<uint64_t> values = { 0, 1, 127, 128, 300, 0xffffffffull, ~0ull };
+    for (auto value : values) {
+        telemetry::PutVarint(bytes, value);
+    }
+    EXPECT_EQ(bytes.size(), 1u + 1u + 1u + 2u + 2u + 5u + 10u);
+
+    const uint8_t *in = bytes.data();
+    for (auto value : values) {
+        uint64_t decoded;
+        ASSERT_TRUE(telemetry::GetVarint(in, bytes.data() + bytes.size(), decoded));
+        EXPECT_EQ(decoded, value);
+    }
+    uint64_t decoded;
+    EXPECT_FALSE(telemetry::GetVarint(in, bytes.data() + bytes.size(), decoded));
+}
+
+TEST(TestTelemetry, ReaderDecodesSampledFrames)
+{
+    ecs::Scene scene;
+    std::vector<ecs::Entity::Id> ids;
+    for (auto i = 0; i < 50; i++) {
+        ids.push_back(scene.NewEntity());
+        scene.AddComponent<component::Transform>(ids.back(), glm::vec2(i, 2 * i), glm::vec2(1.0f, 0.0f), glm::vec2(1.0f));
+        scene.AddComponent<component::Move>(ids.back(), glm::vec2(-i, 0.5f), 1.0f, 100.0f, 10.0f);
+    }
+
+    auto path = testing::TempDir() + "telemetry.bin";
+    {
+        Telemetry exporter(path, 2, 64);
+        ASSERT_TRUE(exporter.IsOpen());
+        for (uint64_t tick = 0; tick < 10; tick++) {
+            ecs::SceneView<component::Transform>(scene).Each([](component::Transform &t) {
+                t.position.x += 0.25f;
+            });
+            if (tick == 5) {
+                scene.RemoveEntity(ids[3]);
+            }
+            EXPECT_TRUE(exporter.Record(scene, tick));
+        }
+        exporter.Flush();
+        EXPECT_EQ(exporter.GetDropped(), 0u);
+        EXPECT_LT(0u, exporter.GetBytes());
+    }
+
+    telemetry::Reader reader(path);
+    ASSERT_TRUE(reader.IsOpen());
+    telemetry::Frame frame;
+    for (uint64_t tick = 0; tick < 10; tick += 2) {
+        ASSERT_TRUE(reader.Next(frame));
+        EXPECT_EQ(frame.tick, tick);
+        ASSERT_EQ(frame.Size(), tick <= 5 ? 50u : 49u);
+        for (size_t i = 0; i < frame.Size(); i++) {
+            if (!scene.IsAlive(frame.ids[i])) {
+                EXPECT_EQ(frame.ids[i], ids[3]);
+                continue;
+            }
+            auto t = scene.GetComponent<component::Transform>(frame.ids[i]);
+            auto m = scene.GetComponent<component::Move>(frame.ids[i]);
+            EXPECT_EQ(frame.px[i], t->position.x - 0.25f * (9 - tick));
+            EXPECT_EQ(frame.py[i], t->position.y);
+            EXPECT_EQ(frame.vx[i], m->velocity.x);
+            EXPECT_EQ(frame.vy[i], m->velocity.y);
+        }
+    }
+    EXPECT_FALSE(reader.Next(frame));
+    std::remove(path.c_str());
+}
+
+TEST(TestTelemetry, DropsFramesWithoutFile)
+{
+    ecs::Scene scene;
+    Telemetry exporter(testing::TempDir() + "missing/telemetry.bin");
+    EXPECT_FALSE(exporter.IsOpen());
+    EXPECT_FALSE(exporter.Record(scene, 0));
+    EXPECT_EQ(exporter.GetDropped(), 1u);
+}
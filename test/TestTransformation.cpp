@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 
+#include <cmath>
+#include <vector>
+
 #include "Transformation.h"
 
 TEST(TestTransformation, NoTransform)
@@ -67,3 +70,80 @@ TEST(TestTransformation, CombinedTransform)
     EXPECT_NEAR(worldPoint.x, expectedPoint.x, 1e-5);
     EXPECT_NEAR(worldPoint.y, expectedPoint.y, 1e-5);
 }
+
+namespace {
+
+/**
+ * The rotation TransformMatrix used to build with trigonometry.
+ */
+glm::vec2 TrigRotation(const glm::vec2 &heading)
+{
+    float rotation = std::atan2(-heading.y, heading.x);
+    return glm::vec2(std::cos(rotation), std::sin(rotation));
+}
+
+}  // namespace
+
+TEST(TestTransformation, RotationMatchesTrigonometry)
+{
+    for (auto angle = -3.0f; angle <= 3.0f; angle += 0.25f) {
+        glm::vec2 heading(std::cos(angle), std::sin(angle));
+        for (auto length : { 1.0f, 0.5f, 40.0f }) {
+            auto r = steering::Rotation(heading * length);
+            auto e = TrigRotation(heading * length);
+            EXPECT_NEAR(r.x, e.x, 1e-6);
+            EXPECT_NEAR(r.y, e.y, 1e-6);
+        }
+    }
+
+    // A zero heading doesn't rotate, as atan2(0, 0) is 0
+    auto r = steering::Rotation(glm::vec2(0.0f));
+    EXPECT_EQ(r.x, 1.0f);
+    EXPECT_EQ(r.y, 0.0f);
+}
+
+TEST(TestTransformation, ToWorldMatchesMatrix)
+{
+    glm::vec2 localPoint(10.0f, 20.0f);
+    glm::vec2 position(100.0f, 200.0f);
+    glm::vec2 heading(0.6f, -0.8f);
+    glm::vec2 scale(2.0f, 0.5f);
+
+    glm::vec3 expected = steering::TransformMatrix(position, heading, scale) * glm::vec3(localPoint, 1.0f);
+    glm::vec2 worldPoint = steering::ToWorld(localPoint, position, heading, scale);
+
+    EXPECT_NEAR(worldPoint.x, expected.x, 1e-4);
+    EXPECT_NEAR(worldPoint.y, expected.y, 1e-4);
+}
+
+TEST(TestTransformation, ToWorldNTransformsEveryPoint)
+{
+    std::vector<float> angles;
+    std::vector<glm::vec2> points, positions, headings;
+    for (auto i = 0; i < 37; i++) {
+        float angle = i * 0.7f;
+        angles.push_back(angle);
+        points.emplace_back(i * 1.5f, -i * 0.25f);
+        positions.emplace_back(i * 10.0f, 720.0f - i);
+        headings.emplace_back(std::cos(angle), std::sin(angle));
+    }
+    // A zero heading is no rotation, and a heading needn't be normalized
+    angles[5] = 0.0f;
+    headings[5] = glm::vec2(0.0f);
+    angles[6] = std::atan2(4.0f, 3.0f);
+    headings[6] = glm::vec2(3.0f, 4.0f);
+    glm::vec2 scale(2.0f, 0.5f);
+
+    std::vector<glm::vec2> world(points.size());
+    steering::ToWorldN(points.size(), points.data(), positions.data(), headings.data(), scale, world.data());
+
+    for (size_t i = 0; i < points.size(); i++) {
+        // Scaled, then rotated by the heading angle, then translated
+        float c = std::cos(angles[i]);
+        float s = std::sin(angles[i]);
+        auto x = points[i].x * scale.x;
+        auto y = points[i].y * scale.y;
+        EXPECT_NEAR(world[i].x, positions[i].x + c * x - s * y, 1e-3);
+        EXPECT_NEAR(world[i].y, positions[i].y + s * x + c * y, 1e-3);
+    }
+}